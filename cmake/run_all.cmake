@@ -0,0 +1,13 @@
+# cmake -DOUTPUT=<file> -DPROGRAMS=<a;b;...> -P run_all.cmake
+# Runs each program in turn and collects their output into one file.
+file(WRITE ${OUTPUT} "")
+foreach(program IN LISTS PROGRAMS)
+    execute_process(COMMAND ${program}
+                    OUTPUT_VARIABLE out
+                    ERROR_VARIABLE out
+                    RESULT_VARIABLE result)
+    file(APPEND ${OUTPUT} "### ${program}\n${out}\n")
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "${program} exited with ${result}")
+    endif()
+endforeach()
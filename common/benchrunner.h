@@ -0,0 +1,137 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "perfcounter.h"
+
+// What one benchmark scenario cost. Counts are indexed by PerfEvent and
+// are -1 when the kernel wouldn't count that event.
+struct BenchSample {
+    std::string name;
+    double ms;
+    long long counts[perfEventCount];
+    long long peakRssKb; // -1 when unknown
+
+    long long count(PerfEvent e) const {
+        return counts[int(e)];
+    }
+};
+
+// Runs benchmark scenarios under every PerfEvent counter plus wall time
+// and peak RSS, so a regression in, say, removeAll can be put down to
+// cache misses rather than instructions:
+//
+//   BenchRunner runner;
+//   runner.run("removeAll, scattered", [&] { list.removeAll(3); });
+//   runner.summary();
+//
+// Counters the kernel won't give us (no PMU, perf_event_paranoid,
+// containers) print as n/a; times and RSS are reported regardless.
+// Peak RSS is the scenario's own where the kernel lets the high-water
+// mark be reset (Linux, /proc/self/clear_refs), else the process's.
+class BenchRunner {
+private:
+    PerfCounter counters[perfEventCount] = {
+        PerfCounter(PerfEvent::Cycles),
+        PerfCounter(PerfEvent::Instructions),
+        PerfCounter(PerfEvent::CacheMisses),
+        PerfCounter(PerfEvent::BranchMisses),
+        PerfCounter(PerfEvent::L1Misses),
+    };
+    std::vector<BenchSample> samples;
+
+    static void resetPeakRss() {
+#ifdef __linux__
+        if (std::FILE* f = std::fopen("/proc/self/clear_refs", "w")) {
+            std::fputs("5", f);
+            std::fclose(f);
+        }
+#endif
+    }
+
+    static long long peakRssKb() {
+        long long kb = -1;
+#ifdef __linux__
+        if (std::FILE* f = std::fopen("/proc/self/status", "r")) {
+            char line[256];
+            while (std::fgets(line, sizeof(line), f)) {
+                if (std::sscanf(line, "VmHWM: %lld kB", &kb) == 1) break;
+            }
+            std::fclose(f);
+        }
+#endif
+        return kb;
+    }
+
+    static std::string show(long long count) {
+        return count < 0 ? "n/a" : std::to_string(count);
+    }
+
+public:
+    BenchRunner() = default;
+    BenchRunner(const BenchRunner&) = delete;
+    BenchRunner& operator=(const BenchRunner&) = delete;
+
+    bool countersAvailable() const {
+        for (const PerfCounter& c : counters) {
+            if (c.available()) return true;
+        }
+        return false;
+    }
+
+    // Runs f once under the counters, prints "name: <ms> ms" and keeps
+    // the sample for summary(). Returns the wall time.
+    template <typename F>
+    double run(const std::string& name, F f) {
+        resetPeakRss();
+        for (PerfCounter& c : counters) c.start();
+        auto start = std::chrono::steady_clock::now();
+        f();
+        auto end = std::chrono::steady_clock::now();
+        BenchSample sample {name, std::chrono::duration<double, std::milli>(end - start).count(), {}, 0};
+        for (int e = perfEventCount - 1; e >= 0; e--) sample.counts[e] = counters[e].stop();
+        sample.peakRssKb = peakRssKb();
+        samples.push_back(sample);
+        std::cout << name << ": " << sample.ms << " ms" << std::endl;
+        return sample.ms;
+    }
+
+    const std::vector<BenchSample>& results() const {
+        return samples;
+    }
+
+    // One row per scenario: time, cycles, instructions, IPC, misses
+    // (L1 data, last level, branch) and peak RSS.
+    void summary(std::ostream& out = std::cout) const {
+        std::size_t width = 8;
+        for (const BenchSample& s : samples) width = std::max(width, s.name.size());
+        out << std::left << std::setw(int(width)) << "scenario" << std::right
+            << std::setw(10) << "ms" << std::setw(14) << "cycles" << std::setw(14) << "instr"
+            << std::setw(6) << "IPC" << std::setw(12) << "L1 miss" << std::setw(12) << "LLC miss"
+            << std::setw(12) << "br miss" << std::setw(12) << "peak RSS" << std::endl;
+        for (const BenchSample& s : samples) {
+            long long cycles = s.count(PerfEvent::Cycles);
+            long long instructions = s.count(PerfEvent::Instructions);
+            std::string ipc = "n/a";
+            if (cycles > 0 && instructions >= 0) {
+                char buf[16];
+                std::snprintf(buf, sizeof(buf), "%.2f", double(instructions) / cycles);
+                ipc = buf;
+            }
+            out << std::left << std::setw(int(width)) << s.name << std::right
+                << std::setw(10) << std::fixed << std::setprecision(3) << s.ms << std::defaultfloat
+                << std::setw(14) << show(cycles) << std::setw(14) << show(instructions)
+                << std::setw(6) << ipc
+                << std::setw(12) << show(s.count(PerfEvent::L1Misses))
+                << std::setw(12) << show(s.count(PerfEvent::CacheMisses))
+                << std::setw(12) << show(s.count(PerfEvent::BranchMisses))
+                << std::setw(12) << (s.peakRssKb < 0 ? std::string("n/a") : std::to_string(s.peakRssKb) + " kB")
+                << std::endl;
+        }
+        if (!countersAvailable()) out << "(perf counters unavailable: times and RSS only)" << std::endl;
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+
+// What one pass over a chain found out.
+struct ChainShape {
+    bool cyclic {false};
+    long long nodes {0};        // distinct nodes: the tail plus the cycle, if any
+    long long cycleStart {-1};  // position of the first node on the cycle
+    long long cycleLength {0};
+};
+
+// Brent's cycle detection over a nullptr-terminated (or corrupted,
+// looping) chain, noting every stride-th node on the way. Afterwards
+// any position is at most stride - 1 hops from a noted node, which is
+// what middle and k-th-from-end queries need. T links through `next`;
+// private node types befriend ChainAnalysis<T>.
+template <typename T>
+class ChainAnalysis {
+private:
+    static const int stride = 256;
+    std::vector<T*> marks; // marks[i] is the node at position i * stride
+    ChainShape result;
+    long long runs {0};
+
+public:
+    void run(T* first) {
+        runs++;
+        marks.clear();
+        result = ChainShape();
+        if (!first) return;
+
+        // The hare visits positions 1, 2, 3, ... in order; the tortoise
+        // jumps to it at every power of two.
+        marks.push_back(first);
+        T* tortoise = first;
+        T* hare = first->next;
+        long long pos = 1;
+        long long power = 1;
+        long long lambda = 1;
+        while (hare != tortoise) {
+            if (!hare) {
+                result.nodes = pos;
+                return;
+            }
+            if (pos % stride == 0) marks.push_back(hare);
+            if (power == lambda) {
+                tortoise = hare;
+                power *= 2;
+                lambda = 0;
+            }
+            hare = hare->next;
+            pos++;
+            lambda++;
+        }
+
+        // Cycle of length lambda: a pointer lambda nodes ahead of another
+        // meets it exactly at the cycle's first node.
+        long long mu = 0;
+        tortoise = first;
+        hare = first;
+        for (long long i = 0; i < lambda; i++) hare = hare->next;
+        while (tortoise != hare) {
+            tortoise = tortoise->next;
+            hare = hare->next;
+            mu++;
+        }
+        result.cyclic = true;
+        result.cycleStart = mu;
+        result.cycleLength = lambda;
+        result.nodes = mu + lambda;
+        // The hare went round more than once; later marks are repeats
+        marks.resize((result.nodes + stride - 1) / stride);
+    }
+
+    const ChainShape& shape() const {
+        return result;
+    }
+
+    // Walks so far, so callers caching an analysis can check they do.
+    long long passes() const {
+        return runs;
+    }
+
+    // Node at position p (0 = first), nullptr unless 0 <= p < nodes.
+    T* at(long long p) const {
+        if (p < 0 || p >= result.nodes) return nullptr;
+        T* n = marks[p / stride];
+        for (long long i = p % stride; i > 0; i--) n = n->next;
+        return n;
+    }
+};
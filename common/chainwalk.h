@@ -0,0 +1,19 @@
+#pragma once
+
+// Layout measurements over the node chains of both lists. Node types
+// befriend ChainWalker<Node> so it can follow their links.
+template <typename T>
+struct ChainWalker {
+    // Share of hops from first to stop that land more than a cache line
+    // away: 0 for a freshly compacted list, close to 1 once scattered.
+    static double fragmentation(const T* first, const T* stop) {
+        long long hops = 0;
+        long long far = 0;
+        for (const T* n = first; n != stop && n->next != stop; n = n->next) {
+            long long d = reinterpret_cast<const char*>(n->next) - reinterpret_cast<const char*>(n);
+            if (d > 64 || d < -64) far++;
+            hops++;
+        }
+        return hops ? double(far) / hops : 0.0;
+    }
+};
@@ -0,0 +1,194 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+// Read-only, compressed copy of a list, for lists that stop changing
+// but stay around. Values go in blocks of blockSize: each block keeps
+// its first value, min and max, and the rest as zigzag varint deltas
+// from the previous value, so sorted or slowly varying data takes a
+// byte or two per value instead of a node. Scans decode as they go;
+// blocks whose min == max (runs) are summed without decoding, and
+// contains() skips blocks whose range misses.
+//
+// Made by IntLinkedList::freeze() / DoublyLinkedList::freeze() (or a
+// Builder) and turned back into a list with the lists' thaw().
+class FrozenIntList {
+public:
+    static const int blockSize = 128;
+
+private:
+    struct Block {
+        int first;
+        int min;
+        int max;
+        std::uint32_t offset; // deltas of values 1.. start at bytes[offset]
+    };
+
+    std::vector<Block> blocks;
+    std::vector<std::uint8_t> bytes;
+    int count {0};
+
+    static std::uint32_t zigzag(std::uint32_t delta) {
+        return (delta << 1) ^ (0u - (delta >> 31));
+    }
+
+    static std::uint32_t unzigzag(std::uint32_t z) {
+        return (z >> 1) ^ (0u - (z & 1));
+    }
+
+    static std::uint32_t readVarint(const std::uint8_t*& p) {
+        std::uint32_t v = *p++;
+        if (v < 0x80) return v;
+        v &= 0x7f;
+        for (int shift = 7;; shift += 7) {
+            std::uint32_t b = *p++;
+            v |= (b & 0x7f) << shift;
+            if (b < 0x80) return v;
+        }
+    }
+
+    int blockCount(int b) const {
+        return b + 1 < int(blocks.size()) ? blockSize : count - b * blockSize;
+    }
+
+    long long total() const {
+        long long sum = 0;
+        for (int b = 0; b < int(blocks.size()); b++) {
+            if (blocks[b].min == blocks[b].max) {
+                sum += (long long)blocks[b].min * blockCount(b);
+            } else {
+                decode(b, [&sum](int v) { sum += v; });
+            }
+        }
+        return sum;
+    }
+
+    // Calls visit(value) for every value of block b, in order.
+    template <typename F>
+    void decode(int b, F&& visit) const {
+        const Block& block = blocks[b];
+        const std::uint8_t* p = bytes.data() + block.offset;
+        std::uint32_t v = std::uint32_t(block.first);
+        visit(int(v));
+        for (int i = blockCount(b) - 1; i > 0; i--) {
+            v += unzigzag(readVarint(p)); // wraps like the encoder's subtraction
+            visit(int(v));
+        }
+    }
+
+    // Decodes block b into out; returns how many values it holds.
+    int unpack(int b, int* out) const {
+        int n = 0;
+        decode(b, [&](int v) { out[n++] = v; });
+        return n;
+    }
+
+public:
+    // Appends values one by one, then finish() seals the list.
+    class Builder;
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    // Heap bytes held, for comparing against the list it came from.
+    long long memory() const {
+        return (long long)(blocks.capacity() * sizeof(Block) + bytes.capacity());
+    }
+
+    // Calls visit(value) front to back.
+    template <typename F>
+    void forEach(F visit) const {
+        for (int b = 0; b < int(blocks.size()); b++) decode(b, visit);
+    }
+
+    // Wraps on overflow the way the lists' int sums do.
+    int sum() const {
+        return int(total());
+    }
+
+    // From the unwrapped total, like the lists' averages.
+    double average() const {
+        return double(total()) / size();
+    }
+
+    bool contains(int x) const {
+        bool found = false;
+        for (int b = 0; b < int(blocks.size()) && !found; b++) {
+            if (x < blocks[b].min || x > blocks[b].max) continue;
+            decode(b, [&found, x](int v) { found |= v == x; });
+        }
+        return found;
+    }
+
+    // Compares a block from each end at a time, decoded into buffers.
+    bool isPalindrome() const {
+        int front[blockSize];
+        int back[blockSize];
+        int fb = 0;
+        int bb = int(blocks.size()) - 1;
+        if (bb < 0) return true; // vacuously
+        unpack(fb, front);
+        int j = unpack(bb, back) - 1;
+        for (int i = 0, left = 0, right = count - 1; left < right; left++, right--, i++, j--) {
+            if (i == blockSize) {
+                unpack(++fb, front);
+                i = 0;
+            }
+            if (j < 0) {
+                j = unpack(--bb, back) - 1;
+            }
+            if (front[i] != back[j]) return false;
+        }
+        return true;
+    }
+
+    void print() const {
+        if (empty()) {
+            std::cout << "List is Empty!" << std::endl;
+            return;
+        }
+        forEach([](int v) { std::cout << v << " "; });
+    }
+};
+
+class FrozenIntList::Builder {
+private:
+    FrozenIntList list;
+    std::uint32_t prev {0};
+
+public:
+    void add(int value) {
+        std::uint32_t v = std::uint32_t(value);
+        if (list.count % blockSize == 0) {
+            list.blocks.push_back({value, value, value, std::uint32_t(list.bytes.size())});
+        } else {
+            Block& block = list.blocks.back();
+            if (value < block.min) block.min = value;
+            if (value > block.max) block.max = value;
+            std::uint32_t z = zigzag(v - prev);
+            while (z >= 0x80) {
+                list.bytes.push_back(std::uint8_t(z | 0x80));
+                z >>= 7;
+            }
+            list.bytes.push_back(std::uint8_t(z));
+        }
+        prev = v;
+        list.count++;
+    }
+
+    FrozenIntList finish() {
+        list.blocks.shrink_to_fit();
+        list.bytes.shrink_to_fit();
+        FrozenIntList done = std::move(list);
+        list = FrozenIntList();
+        prev = 0;
+        return done;
+    }
+};
@@ -0,0 +1,266 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include "nodecache.h"
+#include "nodepool.h"
+#include "reclaimer.h"
+
+// Where a list's nodes come from and how removed ones are given back.
+enum class NodeStorage {
+    Heap,       // new/delete per node (default)
+    Deferred,   // heap nodes; removals park on a retire list freed in bulk
+    Background, // like Deferred, but bulk frees and teardown run on the Reclaimer thread
+    Pool,       // nodes carved from list-owned blocks; teardown drops whole blocks
+    ThreadCache // per-thread free lists over NUMA-local blocks (nodecache.h), no locks
+};
+
+// Nodes kept inside the allocator (so inside the list object) and
+// handed out before the storage mode is asked for any: a list this
+// short never allocates.
+inline constexpr int listInlineNodes = 16;
+
+// Per-list node allocator. T must link through a `next` member and
+// befriend NodeAllocator.
+template <typename T, int Inline = listInlineNodes>
+class NodeAllocator {
+private:
+    static_assert(Inline >= 1 && Inline <= 32, "inline slots are tracked in a 32-bit mask");
+    static const int retireBatch = 4096;
+    static constexpr std::uint32_t allInline = Inline == 32 ? ~0u : (1u << Inline) - 1;
+
+    T local[Inline];
+    std::uint32_t localUsed {0};
+
+    NodeStorage storage;
+    NodePool<T> pool;
+    T* retired {nullptr}; // chained through next
+    int retiredCount {0};
+
+    // Relayout (compaction) state: nodes still waiting to move live in
+    // `vacating` (old blocks) or on the heap; `pool` takes the new ones.
+    bool relayout {false};
+    bool straysCached {false}; // nodes left to move came from ThreadNodeCache
+    NodePool<T> vacating;
+
+    bool isLocal(const T* n) const {
+        std::less_equal<const T*> le;
+        return le(local, n) && le(n, local + Inline - 1);
+    }
+
+    void freeLocal(const T* n) {
+        localUsed &= ~(1u << (n - local));
+    }
+
+    // Frees a node the relayout hasn't moved yet, unless its block goes
+    // away wholesale.
+    void freeStray(T* n) {
+        if (vacating.owns(n)) return;
+        if (straysCached) ThreadNodeCache<T>::local().deallocate(n);
+        else delete n;
+    }
+
+    // During a relayout, frees n.
+    void dropStray(T* n) {
+        if (pool.owns(n)) pool.deallocate(n);
+        else freeStray(n);
+    }
+
+    static void freeChain(T* n) {
+        while (n) {
+            T* next = n->next;
+            delete n;
+            n = next;
+        }
+    }
+
+public:
+    explicit NodeAllocator(NodeStorage s = NodeStorage::Heap): storage(s) {}
+    NodeAllocator(const NodeAllocator&) = delete;
+    NodeAllocator& operator=(const NodeAllocator&) = delete;
+    ~NodeAllocator() {
+        reclaim();
+    }
+
+    NodeStorage mode() const {
+        return storage;
+    }
+
+    // Pooled nodes belong to this allocator's blocks.
+    bool pooled() const {
+        return storage == NodeStorage::Pool;
+    }
+
+    bool cached() const {
+        return storage == NodeStorage::ThreadCache;
+    }
+
+    // Whether n may be relinked into the list allocating from `to`.
+    // Inline nodes live in this list object and pooled ones in its
+    // blocks; heap nodes (Heap, Deferred, Background) are
+    // interchangeable, as are thread-cached ones, but not with each
+    // other. Anything else has to be copied across.
+    bool movable(const T* n, const NodeAllocator& to) const {
+        return !isLocal(n) && !pooled() && !to.pooled() && cached() == to.cached();
+    }
+
+    T* create() {
+        if (localUsed != allInline) {
+            int i = std::countr_one(localUsed);
+            localUsed |= 1u << i;
+            return &local[i];
+        }
+        if (storage == NodeStorage::Pool) return pool.allocate();
+        if (storage == NodeStorage::ThreadCache) return ThreadNodeCache<T>::local().allocate();
+        return new T();
+    }
+
+    // n must already be unlinked from its list.
+    void destroy(T* n) {
+        if (isLocal(n)) {
+            freeLocal(n);
+            return;
+        }
+        if (relayout) {
+            dropStray(n);
+            return;
+        }
+        switch (storage) {
+        case NodeStorage::Heap:
+            delete n;
+            break;
+        case NodeStorage::Pool:
+            pool.deallocate(n);
+            break;
+        case NodeStorage::ThreadCache:
+            ThreadNodeCache<T>::local().deallocate(n);
+            break;
+        default:
+            n->next = retired;
+            retired = n;
+            if (++retiredCount >= retireBatch) reclaim();
+        }
+    }
+
+    // Frees a whole nullptr-terminated chain (every node this allocator
+    // handed out that is still in use) when its list goes away. Pooled
+    // nodes go with their blocks. The allocator can be used again after.
+    void dropChain(T* first) {
+        if (!first) return;
+        if (localUsed) {
+            // Thread the heap nodes past the inline ones
+            T* rest = nullptr;
+            T** tail = &rest;
+            for (T* n = first; n; n = n->next) {
+                if (isLocal(n)) continue;
+                *tail = n;
+                tail = &n->next;
+            }
+            *tail = nullptr;
+            localUsed = 0;
+            first = rest;
+        }
+        if (relayout) {
+            // Mixed chain: only the unmoved nodes need freeing one by one
+            while (first) {
+                T* next = first->next;
+                if (!pool.owns(first)) freeStray(first);
+                first = next;
+            }
+            pool.releaseAll();
+            vacating.releaseAll();
+            relayout = false;
+            return;
+        }
+        if (!first) return;
+        switch (storage) {
+        case NodeStorage::Pool:
+            pool.releaseAll();
+            break;
+        case NodeStorage::ThreadCache:
+            while (first) {
+                T* next = first->next;
+                ThreadNodeCache<T>::local().deallocate(first);
+                first = next;
+            }
+            break;
+        case NodeStorage::Background:
+            Reclaimer::instance().post([first] { freeChain(first); });
+            break;
+        default:
+            freeChain(first);
+        }
+    }
+
+    // Frees everything on the retire list now (or hands it off).
+    void reclaim() {
+        if (!retired) return;
+        T* batch = retired;
+        retired = nullptr;
+        retiredCount = 0;
+        if (storage == NodeStorage::Background) {
+            Reclaimer::instance().post([batch] { freeChain(batch); });
+        } else {
+            freeChain(batch);
+        }
+    }
+
+    int pending() const {
+        return retiredCount;
+    }
+
+    // Compaction: beginRelayout() switches the list to Pool storage in
+    // fresh blocks sized for `count` nodes; the list then passes each
+    // node through relocate() in order and calls endRelayout().
+    bool relayingOut() const {
+        return relayout;
+    }
+
+    void beginRelayout(int count) {
+        reclaim();
+        pool.swap(vacating); // old blocks (if any) are vacated
+        pool.reserve(count);
+        if (!relayout) straysCached = cached();
+        storage = NodeStorage::Pool;
+        relayout = true;
+    }
+
+    // Returns n if it already sits in the new blocks; otherwise a copy in
+    // the next free slot, with n freed. The caller relinks the neighbours.
+    T* relocate(T* n) {
+        if (pool.owns(n)) return n;
+        T* moved = pool.allocate();
+        *moved = *n;
+        if (isLocal(n)) freeLocal(n);
+        else freeStray(n);
+        return moved;
+    }
+
+    void endRelayout() {
+        vacating.releaseAll();
+        relayout = false;
+    }
+
+    // Moving a whole list to another (empty) allocator, as when a list's
+    // nodes leave the list object: adopt() takes over everything but the
+    // inline nodes, then each node goes through takeOver(), which copies
+    // the inline ones into the same slot here and returns the rest as is.
+    void adopt(NodeAllocator& from) {
+        storage = from.storage;
+        pool.swap(from.pool);
+        vacating.swap(from.vacating);
+        std::swap(retired, from.retired);
+        std::swap(retiredCount, from.retiredCount);
+        std::swap(relayout, from.relayout);
+        std::swap(straysCached, from.straysCached);
+    }
+
+    T* takeOver(NodeAllocator& from, T* n) {
+        if (!from.isLocal(n)) return n;
+        int i = n - from.local;
+        local[i] = *n;
+        localUsed |= 1u << i;
+        from.freeLocal(n);
+        return &local[i];
+    }
+};
@@ -0,0 +1,161 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+#ifdef LIST_HAVE_NUMA
+#include <numa.h>
+#endif
+
+// Memory behind NodeStorage::ThreadCache. Each thread allocates and
+// frees nodes through its own ThreadNodeCache, with no locking; caches
+// trade nodes with the process-wide NodeDepot a batch at a time, so a
+// thread that mostly frees what others allocated hands them back in
+// bulk instead of growing without bound.
+//
+// Blocks are carved by the thread that needs them, one node at a time
+// as they are handed out, so their pages sit on that thread's NUMA
+// node: through libnuma when built with it (LIST_HAVE_NUMA), otherwise
+// by the kernel's first-touch placement. Blocks are never returned;
+// freed nodes go back into circulation instead.
+template <typename T>
+class NodeDepot {
+public:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    static_assert(sizeof(T) >= sizeof(FreeSlot), "node too small for the free list");
+    static_assert(std::is_trivially_destructible<T>::value, "cached nodes are never destroyed");
+
+    static const int batch = 256;        // nodes per trade with a cache
+    static const int blockNodes = 1 << 14;
+
+    struct Batch {
+        FreeSlot* first;
+        int count;
+    };
+
+private:
+    std::mutex lock;
+    std::vector<Batch> batches;
+    std::vector<void*> blocks;
+
+    NodeDepot() = default;
+
+public:
+    // Never destroyed: thread caches flush into it as threads exit,
+    // the main thread's after static destructors may have run.
+    static NodeDepot& instance() {
+        static NodeDepot* depot = new NodeDepot;
+        return *depot;
+    }
+
+    Batch take() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (batches.empty()) return {nullptr, 0};
+        Batch b = batches.back();
+        batches.pop_back();
+        return b;
+    }
+
+    void give(Batch b) {
+        if (!b.first) return;
+        std::lock_guard<std::mutex> guard(lock);
+        batches.push_back(b);
+    }
+
+    // Room for blockNodes nodes, local to the calling thread's NUMA node.
+    T* newBlock() {
+        std::size_t bytes = sizeof(T) * blockNodes;
+        void* block = nullptr;
+#ifdef LIST_HAVE_NUMA
+        if (numa_available() >= 0) block = numa_alloc_local(bytes);
+#endif
+        if (!block) block = ::operator new(bytes);
+        std::lock_guard<std::mutex> guard(lock);
+        blocks.push_back(block);
+        return static_cast<T*>(block);
+    }
+};
+
+template <typename T>
+class ThreadNodeCache {
+private:
+    using Depot = NodeDepot<T>;
+    using FreeSlot = typename Depot::FreeSlot;
+    static const int limit = 2 * Depot::batch;
+
+    FreeSlot* freeList {nullptr};
+    int count {0};
+    T* bump {nullptr}; // untouched rest of this thread's block
+    T* end {nullptr};
+
+    ThreadNodeCache() = default;
+
+    // Takes the first n free nodes off the list.
+    typename Depot::Batch split(int n) {
+        FreeSlot* first = freeList;
+        FreeSlot* last = first;
+        for (int i = 1; i < n; i++) last = last->next;
+        freeList = last->next;
+        last->next = nullptr;
+        count -= n;
+        return {first, n};
+    }
+
+    // Keeps the first (most recently freed, warmest) `keep` nodes and
+    // returns the rest.
+    typename Depot::Batch cut(int keep) {
+        FreeSlot* last = freeList;
+        for (int i = 1; i < keep; i++) last = last->next;
+        typename Depot::Batch rest {last->next, count - keep};
+        last->next = nullptr;
+        count = keep;
+        return rest;
+    }
+
+public:
+    ThreadNodeCache(const ThreadNodeCache&) = delete;
+    ThreadNodeCache& operator=(const ThreadNodeCache&) = delete;
+
+    ~ThreadNodeCache() {
+        Depot& depot = Depot::instance();
+        while (bump != end) deallocate(bump++);
+        while (count > 0) depot.give(split(count < Depot::batch ? count : Depot::batch));
+    }
+
+    static ThreadNodeCache& local() {
+        thread_local ThreadNodeCache cache;
+        return cache;
+    }
+
+    T* allocate() {
+        if (!freeList && bump == end) {
+            typename Depot::Batch b = Depot::instance().take();
+            if (b.first) {
+                freeList = b.first;
+                count = b.count;
+            } else {
+                bump = Depot::instance().newBlock();
+                end = bump + Depot::blockNodes;
+            }
+        }
+        void* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = freeList->next;
+            count--;
+        } else {
+            slot = bump++;
+        }
+        return new (slot) T();
+    }
+
+    void deallocate(T* node) {
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+        if (++count >= limit) Depot::instance().give(cut(Depot::batch));
+    }
+};
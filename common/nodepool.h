@@ -0,0 +1,109 @@
+#pragma once
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Carves nodes out of large blocks and recycles freed ones through an
+// intrusive free list. Blocks are only returned when the pool dies, all
+// at once, so the nodes must not need destructors.
+template <typename T>
+class NodePool {
+private:
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+    static_assert(sizeof(T) >= sizeof(FreeSlot), "node too small for the free list");
+    static_assert(std::is_trivially_destructible<T>::value, "pooled nodes are never destroyed");
+
+    static const int firstBlock = 64;
+    static const int maxBlock = 1 << 16;
+
+    struct Block {
+        T* start;
+        T* end;
+    };
+
+    std::vector<Block> blocks; // sorted by address, for owns()
+    T* bump {nullptr};
+    T* end {nullptr};
+    int nextBlock {firstBlock};
+    FreeSlot* freeList {nullptr};
+
+    void grow() {
+        T* block = static_cast<T*>(::operator new(sizeof(T) * nextBlock));
+        Block b {block, block + nextBlock};
+        auto at = std::lower_bound(blocks.begin(), blocks.end(), b,
+                                   [](const Block& x, const Block& y) { return x.start < y.start; });
+        blocks.insert(at, b);
+        bump = block;
+        end = b.end;
+        if (nextBlock < maxBlock) nextBlock *= 2;
+        else nextBlock = maxBlock;
+    }
+
+public:
+    NodePool() = default;
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+    ~NodePool() {
+        releaseAll();
+    }
+
+    T* allocate() {
+        void* slot;
+        if (freeList) {
+            slot = freeList;
+            freeList = freeList->next;
+        } else {
+            if (bump == end) grow();
+            slot = bump++;
+        }
+        return new (slot) T();
+    }
+
+    void deallocate(T* node) {
+        FreeSlot* slot = reinterpret_cast<FreeSlot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+    }
+
+    // Makes the next block hold at least count nodes, so a run of
+    // allocations lands back to back.
+    void reserve(int count) {
+        if (end - bump >= count) return;
+        if (count > nextBlock) nextBlock = count;
+        grow();
+    }
+
+    // True when node came out of one of this pool's blocks.
+    bool owns(const T* node) const {
+        auto at = std::upper_bound(blocks.begin(), blocks.end(), node,
+                                   [](const T* p, const Block& b) { return p < b.start; });
+        if (at == blocks.begin()) return false;
+        --at;
+        return node < at->end;
+    }
+
+    void swap(NodePool& other) {
+        std::swap(blocks, other.blocks);
+        std::swap(bump, other.bump);
+        std::swap(end, other.end);
+        std::swap(nextBlock, other.nextBlock);
+        std::swap(freeList, other.freeList);
+    }
+
+    // Drops every node handed out so far, one free per block.
+    void releaseAll() {
+        for (Block& b : blocks) ::operator delete(b.start);
+        blocks.clear();
+        bump = end = nullptr;
+        nextBlock = firstBlock;
+        freeList = nullptr;
+    }
+
+    int blockCount() const {
+        return int(blocks.size());
+    }
+};
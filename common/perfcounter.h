@@ -0,0 +1,86 @@
+#pragma once
+#include <cstdint>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// CacheMisses are last-level cache misses; L1Misses are L1 data reads
+// that missed.
+enum class PerfEvent { Cycles, Instructions, CacheMisses, BranchMisses, L1Misses };
+inline constexpr int perfEventCount = 5;
+
+// One hardware counter for the calling thread, via perf_event_open.
+// available() is false when the kernel refuses (no PMU, paranoid
+// setting, not Linux); stop() then returns -1. With more counters open
+// than the PMU has, the kernel takes turns and stop() scales the count
+// up by the share of time it was actually counting.
+class PerfCounter {
+private:
+    int fd {-1};
+
+public:
+    explicit PerfCounter(PerfEvent event) {
+#ifdef __linux__
+        perf_event_attr attr {};
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        switch (event) {
+        case PerfEvent::Cycles: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PerfEvent::Instructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PerfEvent::CacheMisses: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+        case PerfEvent::BranchMisses: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case PerfEvent::L1Misses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_L1D |
+                          (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        }
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)event;
+#endif
+    }
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    ~PerfCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool available() const {
+        return fd >= 0;
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+#ifdef __linux__
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        std::uint64_t value[3]; // count, time enabled, time running
+        if (read(fd, value, sizeof(value)) != sizeof(value)) return -1;
+        if (value[2] == 0) return -1; // never got a turn on the PMU
+        if (value[2] == value[1]) return (long long)value[0];
+        return (long long)(double(value[0]) * double(value[1]) / double(value[2]));
+#else
+        return -1;
+#endif
+    }
+};
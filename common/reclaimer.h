@@ -0,0 +1,69 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Single background thread that runs deferred frees off the caller's
+// path. Jobs still queued at exit are finished before the thread joins.
+class Reclaimer {
+private:
+    std::mutex m;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<std::function<void()>> jobs;
+    bool busy {false};
+    bool stopping {false};
+    std::thread worker;
+
+    Reclaimer(): worker([this] { run(); }) {}
+
+    void run() {
+        std::unique_lock<std::mutex> lock(m);
+        while (true) {
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return; // stopping, nothing left
+            std::function<void()> job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+            lock.unlock();
+            job();
+            lock.lock();
+            busy = false;
+            if (jobs.empty()) idle.notify_all();
+        }
+    }
+
+public:
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    ~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stopping = true;
+        }
+        wake.notify_one();
+        worker.join();
+    }
+
+    static Reclaimer& instance() {
+        static Reclaimer reclaimer;
+        return reclaimer;
+    }
+
+    void post(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            jobs.push_back(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    // Blocks until everything posted so far has been freed.
+    void drain() {
+        std::unique_lock<std::mutex> lock(m);
+        idle.wait(lock, [this] { return jobs.empty() && !busy; });
+    }
+};
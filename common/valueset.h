@@ -0,0 +1,79 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Membership filter for "remove any of these values" passes.
+// Values that fit in a small range go into a plain bitset; anything
+// wider uses an open-addressing hash table with linear probing.
+class ValueSet {
+private:
+    static const long long maxDenseRange = 1 << 16;
+
+    bool dense {true};
+    int lo {0};
+    std::vector<uint64_t> bits;
+    std::vector<int> slots;
+    std::vector<unsigned char> used;
+    unsigned mask {0};
+    bool isEmpty {true};
+
+    static unsigned hash(int x) {
+        return (unsigned(x) * 2654435761u) ^ (unsigned(x) >> 16);
+    }
+
+public:
+    explicit ValueSet(std::span<const int> values) {
+        if (values.empty()) return;
+        isEmpty = false;
+
+        int hi = values[0];
+        lo = values[0];
+        for (int v : values) {
+            if (v < lo) lo = v;
+            if (v > hi) hi = v;
+        }
+
+        long long range = (long long)hi - lo + 1;
+        if (range <= maxDenseRange) {
+            bits.assign((range + 63) / 64, 0);
+            for (int v : values) {
+                unsigned off = unsigned((long long)v - lo);
+                bits[off / 64] |= uint64_t(1) << (off % 64);
+            }
+            return;
+        }
+
+        dense = false;
+        unsigned cap = 16;
+        while (cap < values.size() * 2) cap *= 2;
+        slots.assign(cap, 0);
+        used.assign(cap, 0);
+        mask = cap - 1;
+        for (int v : values) {
+            unsigned i = hash(v) & mask;
+            while (used[i] && slots[i] != v) i = (i + 1) & mask;
+            slots[i] = v;
+            used[i] = 1;
+        }
+    }
+
+    bool empty() const {
+        return isEmpty;
+    }
+
+    bool contains(int x) const {
+        if (isEmpty) return false;
+        if (dense) {
+            long long off = (long long)x - lo;
+            if (off < 0 || off >= (long long)bits.size() * 64) return false;
+            return (bits[off / 64] >> (off % 64)) & 1;
+        }
+        unsigned i = hash(x) & mask;
+        while (used[i]) {
+            if (slots[i] == x) return true;
+            i = (i + 1) & mask;
+        }
+        return false;
+    }
+};
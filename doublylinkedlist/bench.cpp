@@ -0,0 +1,565 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <vector>
+#include "dldlist.h"
+#include "ringdeque.h"
+#include "channel.h"
+#include "worksteal.h"
+#include "ilist.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include "../common/perfcounter.h"
+#include "../common/benchrunner.h"
+
+template <typename F>
+double time_ms(F f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void report(const std::string& name, double ms) {
+    std::cout << name << ": " << ms << " ms" << std::endl;
+}
+
+// Destructor time and bulk removal throughput for each storage mode.
+void bench_storage(int n) {
+    std::cout << "\n--- Storage modes, " << n << " nodes ---" << std::endl;
+
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Deferred,
+                           NodeStorage::Background, NodeStorage::Pool, NodeStorage::ThreadCache};
+    std::string names[] = {"Heap", "Deferred", "Background", "Pool", "ThreadCache"};
+
+    for (int m = 0; m < 5; ++m) {
+        DoublyLinkedList* dll = new DoublyLinkedList(modes[m]);
+        for (int i = 0; i < n; ++i) dll->addBack(i % 4);
+
+        int removed = 0;
+        double remove_ms = time_ms([&] { removed = dll->remove_if([](int x) { return x == 1; }); });
+        report(names[m] + " remove_if (" + std::to_string(removed) + " nodes)", remove_ms);
+
+        report(names[m] + " destructor", time_ms([&] { delete dll; }));
+        if (modes[m] == NodeStorage::Background) {
+            report(names[m] + " drain", time_ms([] { Reclaimer::instance().drain(); }));
+        }
+    }
+}
+
+// Random riffles by relinking, so neighbours in the list are no longer
+// neighbours in memory.
+void scatter(DoublyLinkedList& dll, int rounds) {
+    std::mt19937 rng(42);
+    DoublyLinkedList rest;
+    for (int r = 0; r < rounds; ++r) {
+        dll.stable_partition([&rng](int) { return rng() & 1; }, rest);
+        rest.stable_partition([](int) { return false; }, dll);
+    }
+}
+
+// Traversal speed on a scattered list before and after compact(),
+// plus the worst single compactStep() pause.
+void bench_compact(int n) {
+    std::cout << "\n--- Compaction, " << n << " nodes ---" << std::endl;
+
+    DoublyLinkedList dll;
+    for (int i = 0; i < n; ++i) dll.addBack(7);
+    scatter(dll, 10);
+
+    long long sink = 0;
+    std::cout << "fragmentation before: " << dll.fragmentation() << std::endl;
+    report("size+isPalindrome scattered", time_ms([&] { sink += dll.size() + dll.isPalindrome(); }));
+    report("compact()", time_ms([&] { dll.compact(); }));
+    std::cout << "fragmentation after: " << dll.fragmentation() << std::endl;
+    report("size+isPalindrome compacted", time_ms([&] { sink += dll.size() + dll.isPalindrome(); }));
+
+    scatter(dll, 10);
+    std::vector<double> pauses;
+    bool done = false;
+    while (!done) {
+        pauses.push_back(time_ms([&] { done = dll.compactStep(10000); }));
+    }
+    std::sort(pauses.begin(), pauses.end());
+    report("compactStep(10000) median", pauses[pauses.size() / 2]);
+    report("compactStep(10000) worst", pauses.back());
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+// Queue-only traffic on both backends: a sliding window (push back,
+// pop front), a mixed-ends churn, then size() and isPalindrome().
+template <QueueBackend Q>
+void bench_queue_ops(const std::string& name, int n) {
+    long long sink = 0;
+    Q q;
+    report(name + " build (addBack)", time_ms([&] {
+        for (int i = 0; i < n; ++i) q.addBack(7);
+    }));
+    report(name + " sliding window", time_ms([&] {
+        for (int i = 0; i < n; ++i) {
+            q.addBack(7);
+            q.removeFront();
+        }
+    }));
+    std::mt19937 rng(3);
+    report(name + " mixed ends", time_ms([&] {
+        for (int i = 0; i < n; ++i) {
+            unsigned r = rng();
+            if (r & 1) q.addFront(7); else q.addBack(7);
+            if (r & 2) q.removeFront(); else q.removeBack();
+            sink += q.front();
+        }
+    }));
+    report(name + " size()", time_ms([&] { sink += q.size(); }));
+    report(name + " isPalindrome()", time_ms([&] { sink += q.isPalindrome(); }));
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+void bench_deque(int n) {
+    std::cout << "\n--- Queue ops, node list vs ring buffer, " << n << " elements ---" << std::endl;
+    bench_queue_ops<DoublyLinkedList>("DoublyLinkedList", n);
+    bench_queue_ops<RingDeque>("RingDeque", n);
+}
+
+// Pipeline stages for bench_pipeline.
+template <QueueBackend Q>
+Task feed(Channel<Q>& ch, int n) {
+    for (int i = 0; i < n; ++i) co_await ch.push_back(i & 1023);
+    ch.close();
+}
+
+template <QueueBackend Q>
+Task drain_one(Channel<Q>& ch, long long& sink) {
+    while (auto v = co_await ch.pop_front()) sink += *v;
+}
+
+template <QueueBackend Q>
+Task drain_batch(Channel<Q>& ch, int max, long long& sink) {
+    while (true) {
+        std::vector<int> batch = co_await ch.pop_front(max);
+        if (batch.empty()) break;
+        for (int v : batch) sink += v;
+    }
+}
+
+// One producer and one consumer moving n values through a bounded
+// buffer: the mutex + condition_variable queue we use today against
+// the coroutine channel on both executors.
+void bench_pipeline(int n, int capacity) {
+    std::cout << "\n--- Producer/consumer pipeline, " << n << " values, capacity "
+              << capacity << " ---" << std::endl;
+    long long sink = 0;
+
+    report("mutex+condvar, 2 threads", time_ms([&] {
+        DoublyLinkedList queue;
+        int count = 0;
+        bool finished = false;
+        std::mutex lock;
+        std::condition_variable not_full, not_empty;
+        std::thread producer([&] {
+            for (int i = 0; i < n; ++i) {
+                std::unique_lock<std::mutex> guard(lock);
+                not_full.wait(guard, [&] { return count < capacity; });
+                queue.addBack(i & 1023);
+                ++count;
+                not_empty.notify_one();
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            finished = true;
+            not_empty.notify_one();
+        });
+        while (true) {
+            std::unique_lock<std::mutex> guard(lock);
+            not_empty.wait(guard, [&] { return count > 0 || finished; });
+            if (count == 0) break;
+            sink += queue.front();
+            queue.removeFront();
+            --count;
+            not_full.notify_one();
+        }
+        producer.join();
+    }));
+
+    report("channel, loop executor", time_ms([&] {
+        LoopExecutor loop;
+        Channel<> ch(loop, capacity);
+        loop.spawn(drain_one(ch, sink));
+        loop.spawn(feed(ch, n));
+        loop.run();
+    }));
+
+    report("channel, loop executor, pop_front(64)", time_ms([&] {
+        LoopExecutor loop;
+        Channel<> ch(loop, capacity);
+        loop.spawn(drain_batch(ch, 64, sink));
+        loop.spawn(feed(ch, n));
+        loop.run();
+    }));
+
+    report("channel<RingDeque>, loop executor, pop_front(64)", time_ms([&] {
+        LoopExecutor loop;
+        Channel<RingDeque> ch(loop, capacity);
+        loop.spawn(drain_batch(ch, 64, sink));
+        loop.spawn(feed(ch, n));
+        loop.run();
+    }));
+
+    report("channel, 2-thread pool, pop_front(64)", time_ms([&] {
+        ThreadPoolExecutor pool(2);
+        Channel<> ch(pool, capacity);
+        pool.spawn(drain_batch(ch, 64, sink));
+        pool.spawn(feed(ch, n));
+        pool.wait();
+    }));
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+// Sum of one chunk, made heavier than a plain add so scheduling isn't
+// the only thing measured.
+long long chunk_sum(const RingDeque& d, int lo, int hi) {
+    long long s = 0;
+    for (int i = lo; i < hi; ++i) s += (d[i] * 2654435761u) >> 7;
+    return s;
+}
+
+// Aggregate over a RingDeque split into chunks: the shared
+// DoublyLinkedList of chunk ids under a mutex (today's scheduler)
+// against parallel_reduce on the work-stealing pool, per thread count.
+void bench_work_stealing(int n, int grain) {
+    std::cout << "\n--- Scheduling " << n / grain << " chunks of " << grain
+              << ", hardware threads: " << std::thread::hardware_concurrency() << " ---" << std::endl;
+    RingDeque data;
+    for (int i = 0; i < n; ++i) data.addBack(i);
+    long long sink = 0;
+
+    for (int threads = 1; threads <= 8; threads *= 2) {
+        report("shared list, " + std::to_string(threads) + " threads", time_ms([&] {
+            DoublyLinkedList ids;
+            std::mutex lock;
+            for (int c = 0; c < n / grain; ++c) ids.addBack(c);
+            std::atomic<long long> total {0};
+            auto worker = [&] {
+                long long mine = 0;
+                while (true) {
+                    int c;
+                    {
+                        std::lock_guard<std::mutex> guard(lock);
+                        if (ids.empty()) break;
+                        c = ids.front();
+                        ids.removeFront();
+                    }
+                    mine += chunk_sum(data, c * grain, (c + 1) * grain);
+                }
+                total += mine;
+            };
+            std::vector<std::thread> pool;
+            for (int t = 1; t < threads; ++t) pool.emplace_back(worker);
+            worker();
+            for (std::thread& t : pool) t.join();
+            sink += total;
+        }));
+
+        WorkStealingPool pool(threads);
+        report("work stealing, " + std::to_string(threads) + " threads", time_ms([&] {
+            sink += pool.parallel_reduce(0, n, grain, 0LL,
+                [&](int lo, int hi) { return chunk_sum(data, lo, hi); },
+                [](long long a, long long b) { return a + b; });
+        }));
+    }
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+// Millions of short-lived small lists, the way request handlers use
+// them. Sentinels and the first listInlineNodes nodes live inside the
+// list object; the baseline allocates them all, as before.
+void bench_small_lists(int lists) {
+    std::cout << "\n--- " << lists << " short-lived small lists ---" << std::endl;
+    struct HeapNode {
+        int elem;
+        HeapNode* prev;
+        HeapNode* next;
+    };
+    long long sink = 0;
+    for (int size : {4, 8, 16, 20}) {
+        report("node per allocation, " + std::to_string(size) + " nodes", time_ms([&] {
+            for (int l = 0; l < lists; ++l) {
+                HeapNode* header = new HeapNode {0, nullptr, nullptr};
+                HeapNode* trailer = new HeapNode {0, header, nullptr};
+                header->next = trailer;
+                for (int i = 0; i < size; ++i) {
+                    HeapNode* n = new HeapNode {i, trailer->prev, trailer};
+                    trailer->prev->next = n;
+                    trailer->prev = n;
+                }
+                for (HeapNode* n = header; n;) {
+                    HeapNode* next = n->next;
+                    sink += n->elem;
+                    delete n;
+                    n = next;
+                }
+            }
+        }));
+        report("DoublyLinkedList, " + std::to_string(size) + " nodes", time_ms([&] {
+            for (int l = 0; l < lists; ++l) {
+                DoublyLinkedList dll;
+                for (int i = 0; i < size; ++i) dll.addBack(i);
+                sink += dll.back() + dll.size();
+            }
+        }));
+    }
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+// Update jobs of `changes` mixed edits on an n-node list that get
+// aborted. Today's jobs keep a copy to fall back on, and the first
+// write after copying duplicates the list; a transaction only logs
+// the edits.
+void bench_transactions(int n, int changes, int jobs) {
+    std::cout << "\n--- " << jobs << " aborted batches of " << changes
+              << " changes on " << n << " nodes ---" << std::endl;
+    DoublyLinkedList dll;
+    for (int i = 0; i < n; ++i) dll.addBack(i);
+    auto batch = [changes](DoublyLinkedList& target) {
+        for (int c = 0; c < changes; c += 4) {
+            target.addFront(c);
+            target.addBack(c);
+            target.removeFront();
+            target.removeBack();
+            target.removeBack();
+        }
+    };
+    long long sink = 0;
+
+    report("copy, then restore it", time_ms([&] {
+        for (int j = 0; j < jobs; ++j) {
+            DoublyLinkedList backup = dll;
+            batch(dll);
+            dll = backup;
+            sink += dll.back();
+        }
+    }));
+    report("begin, then rollback", time_ms([&] {
+        for (int j = 0; j < jobs; ++j) {
+            dll.begin();
+            batch(dll);
+            dll.rollback();
+            sink += dll.back();
+        }
+    }));
+    report("begin, then commit", time_ms([&] {
+        for (int j = 0; j < jobs; ++j) {
+            dll.begin();
+            batch(dll);
+            dll.commit();
+            sink += dll.back();
+        }
+    }));
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+// isPalindrome() on a list against its frozen copy, which decodes a
+// block from each end at a time.
+void bench_freeze(int n) {
+    std::cout << "\n--- Frozen palindrome scan, " << n << " values ---" << std::endl;
+    DoublyLinkedList dll;
+    for (int i = 0; i < n / 2; ++i) dll.addBack(i);
+    for (int i = n / 2 - 1; i >= 0; --i) dll.addBack(i);
+    bool same = true;
+    report("DoublyLinkedList isPalindrome", time_ms([&] { same = dll.isPalindrome(); }));
+    FrozenIntList frozen;
+    report("freeze", time_ms([&] { frozen = dll.freeze(); }));
+    std::cout << "memory: " << n * 24LL << " bytes of nodes vs " << frozen.memory() << " frozen" << std::endl;
+    report("FrozenIntList isPalindrome", time_ms([&] { same = same && frozen.isPalindrome(); }));
+    report("thaw", time_ms([&] { dll.thaw(frozen); }));
+    std::cout << "(palindrome " << same << ")" << std::endl;
+}
+
+// Independent per-thread lists doing addBack/removeFront churn over a
+// standing backlog, heap nodes against per-thread caches. Throughput
+// should grow with threads up to the core count.
+void bench_thread_churn(int ops_per_thread, int backlog) {
+    std::cout << "\n--- Per-thread churn, " << ops_per_thread << " ops per thread, backlog " << backlog
+              << ", hardware threads: " << std::thread::hardware_concurrency() << " ---" << std::endl;
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::ThreadCache};
+    std::string names[] = {"Heap", "ThreadCache"};
+    for (int m = 0; m < 2; ++m) {
+        for (int threads = 1; threads <= 8; threads *= 2) {
+            double ms = time_ms([&] {
+                std::vector<std::thread> pool;
+                for (int t = 0; t < threads; ++t) {
+                    pool.emplace_back([&] {
+                        DoublyLinkedList dll(modes[m]);
+                        for (int i = 0; i < backlog; ++i) dll.addBack(i);
+                        for (int i = 0; i < ops_per_thread; ++i) {
+                            dll.addBack(i);
+                            dll.removeFront();
+                        }
+                    });
+                }
+                for (std::thread& th : pool) th.join();
+            });
+            report(names[m] + ", " + std::to_string(threads) + " threads ("
+                   + std::to_string(int(2.0 * threads * ops_per_thread / ms / 1000)) + " M ops/s)", ms);
+        }
+    }
+}
+
+// A queue of caller-owned entries, some cancelled from the middle:
+// DoublyLinkedList allocates a node per entry and finds a cancelled one
+// by value; an intrusive list links the entries themselves and unlinks
+// the one it is handed.
+void bench_intrusive(int n, int cancels) {
+    std::cout << "\n--- Queue of " << n << " entries, " << cancels << " cancelled ---" << std::endl;
+    struct Entry : ListHook<> {
+        int id;
+    };
+    std::vector<Entry> entries(n);
+    for (int i = 0; i < n; ++i) entries[i].id = i;
+    std::mt19937 rng(7);
+    std::vector<int> cancelled(cancels);
+    for (int& c : cancelled) c = rng() % n;
+    long long sink = 0;
+
+    DoublyLinkedList dll;
+    report("DoublyLinkedList fill", time_ms([&] {
+        for (int i = 0; i < n; ++i) dll.addBack(entries[i].id);
+    }));
+    report("DoublyLinkedList cancel", time_ms([&] {
+        for (int c : cancelled) dll.remove_if([c](int id) { return id == c; });
+    }));
+    report("DoublyLinkedList drain", time_ms([&] {
+        while (!dll.empty()) {
+            sink += dll.front();
+            dll.removeFront();
+        }
+    }));
+
+    IntrusiveList<Entry> list;
+    report("IntrusiveList fill", time_ms([&] {
+        for (int i = 0; i < n; ++i) list.addBack(entries[i]);
+    }));
+    report("IntrusiveList cancel", time_ms([&] {
+        for (int c : cancelled) entries[c].unlink();
+    }));
+    report("IntrusiveList drain", time_ms([&] {
+        while (!list.empty()) {
+            sink -= list.front().id;
+            list.removeFront();
+        }
+    }));
+    std::cout << "(difference " << sink << ", 0 if both agree)" << std::endl;
+}
+
+// isPalindrome, size and a full remove_if pass under the hardware
+// counters, scattered and then compacted, to tell cache misses apart
+// from extra work when one of them regresses.
+void bench_counters(int n) {
+    std::cout << "\n--- Counters: " << n << " nodes, scattered vs compacted ---" << std::endl;
+    DoublyLinkedList dll;
+    for (int i = 0; i < n; ++i) dll.addBack(7); // palindrome: full walk
+    scatter(dll, 10);
+
+    BenchRunner runner;
+    long long sink = 0;
+    for (std::string layout : {"scattered", "compacted"}) {
+        if (layout == "compacted") dll.compact();
+        runner.run("isPalindrome, " + layout, [&] { sink += dll.isPalindrome(); });
+        runner.run("size, " + layout, [&] { sink += dll.size(); });
+        runner.run("remove_if (no match), " + layout, [&] {
+            sink += dll.remove_if([](int x) { return x < 0; });
+        });
+    }
+    runner.summary();
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+// Values drawn from [0, distinct); the peak RSS of building the list and
+// then the index shows what the index costs in memory.
+void bench_range_queries(int n, int queries, int scans, int distinct) {
+    std::cout << "\n--- Range queries on " << n << " values, " << distinct << " distinct: " << scans
+              << " linear scans vs " << queries << " indexed ---" << std::endl;
+    std::mt19937 rng(42);
+    DoublyLinkedList dll;
+    BenchRunner runner;
+    runner.run("addBack " + std::to_string(n), [&] {
+        for (int i = 0; i < n; ++i) dll.addBack(int(rng() % distinct));
+    });
+    struct Query {
+        int i, j, value;
+    };
+    std::vector<Query> ranges(queries);
+    for (auto& [i, j, value] : ranges) {
+        i = int(rng() % n);
+        j = i + int(rng() % (n - i + 1));
+        value = int(rng() % distinct);
+    }
+
+    long long sink = 0;
+    auto ask = [&](int count, const std::string& what) {
+        return time_ms([&] {
+            for (int q = 0; q < count; ++q) {
+                auto [i, j, value] = ranges[q];
+                if (what == "sum") sink += dll.rangeSum(i, j);
+                else if (what == "min/max") sink += dll.rangeMin(i, j) + dll.rangeMax(i, j);
+                else sink += dll.rangeCount(i, j, value);
+            }
+        });
+    };
+    for (std::string what : {"sum", "min/max", "count"}) {
+        report("linear " + what + ", per query", ask(scans, what) / scans);
+    }
+    runner.run("buildIndex + first query", [&] {
+        dll.buildIndex();
+        sink += dll.rangeCount(0, n, 7);
+    });
+    runner.summary();
+    for (std::string what : {"sum", "min/max", "count"}) {
+        report("indexed " + what + ", per query", ask(queries, what) / queries);
+    }
+
+    // What keeping the index costs the queue ops
+    for (bool indexed : {true, false}) {
+        if (!indexed) dll.dropIndex();
+        report(std::string("1M addFront + removeBack, ") + (indexed ? "indexed" : "no index"), time_ms([&] {
+            for (int i = 0; i < 1000000; ++i) {
+                dll.addFront(i % 100);
+                dll.removeBack();
+            }
+        }));
+    }
+    std::cout << "(checksum " << sink << ")" << std::endl;
+}
+
+int main() {
+    std::cout << "=== DoublyLinkedList Benchmarks ===" << std::endl;
+
+    bench_storage(5000000);
+
+    bench_compact(2000000);
+
+    bench_deque(2000000);
+
+    bench_pipeline(2000000, 256);
+
+    bench_work_stealing(1 << 24, 4096);
+
+    bench_small_lists(2000000);
+
+    bench_transactions(1000000, 1000, 100);
+
+    bench_freeze(4000000);
+
+    bench_thread_churn(2000000, 1000);
+
+    bench_intrusive(1000000, 50);
+
+    bench_counters(2000000);
+
+    bench_range_queries(10000000, 100000, 10, 100);
+    bench_range_queries(10000000, 100000, 10, 10000000);
+
+    return 0;
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <coroutine>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <vector>
+#include "ringdeque.h"
+#include "executor.h"
+
+// Bounded FIFO channel between coroutines, buffered in a queue backend
+// (DoublyLinkedList by default). Instead of polling empty():
+//
+//   bool ok = co_await ch.push_back(v);        // waits while full; false once closed
+//   std::optional<int> v = co_await ch.pop_front();   // waits while empty
+//   std::vector<int> vs = co_await ch.pop_front(64);  // up to 64 in one resumption
+//
+// Pops return nothing (nullopt / empty vector) once the channel is
+// closed and drained. Woken coroutines are rescheduled on the executor.
+// Safe to share between threads of a ThreadPoolExecutor.
+template <QueueBackend Q = DoublyLinkedList>
+class Channel {
+private:
+    struct PushAwaiter {
+        Channel& ch;
+        int value;
+        bool ok {true};
+        std::coroutine_handle<> waiting {};
+
+        bool await_ready() { return false; }
+        bool await_suspend(std::coroutine_handle<> h) { return ch.push(*this, h); }
+        bool await_resume() { return ok; }
+    };
+
+    template <bool Batch>
+    struct PopAwaiter {
+        Channel& ch;
+        int max;
+        int got {0};
+        int single {0};
+        std::vector<int> batch {};
+
+        void take(int v) {
+            if constexpr (Batch) batch.push_back(v);
+            else single = v;
+            got++;
+        }
+
+        bool await_ready() { return false; }
+        bool await_suspend(std::coroutine_handle<> h) { return ch.pop(*this, h); }
+        auto await_resume() {
+            if constexpr (Batch) return std::move(batch);
+            else return got ? std::optional<int>(single) : std::nullopt;
+        }
+    };
+
+    // A waiting popper of either kind; it wakes with one pushed value.
+    struct Popper {
+        void* awaiter;
+        void (*take)(void*, int);
+        std::coroutine_handle<> waiting {};
+    };
+
+    std::mutex lock;
+    Executor& executor;
+    Q buffer;
+    int count {0};   // buffer.size() may be O(n)
+    int capacity;
+    bool closed {false};
+    std::deque<PushAwaiter*> pushers; // full: waiting with a value
+    std::deque<Popper> poppers;       // empty: waiting for one
+
+    // Each returns true when the coroutine has to suspend.
+    bool push(PushAwaiter& a, std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (closed) {
+            a.ok = false;
+            return false;
+        }
+        if (!poppers.empty()) {
+            // Only happens with an empty buffer: hand the value over
+            Popper p = poppers.front();
+            poppers.pop_front();
+            p.take(p.awaiter, a.value);
+            executor.schedule(p.waiting);
+            return false;
+        }
+        if (count < capacity) {
+            buffer.addBack(a.value);
+            count++;
+            return false;
+        }
+        a.waiting = h;
+        pushers.push_back(&a);
+        return true;
+    }
+
+    template <bool Batch>
+    bool pop(PopAwaiter<Batch>& a, std::coroutine_handle<> h) {
+        std::lock_guard<std::mutex> guard(lock);
+        while (a.got < a.max && count > 0) {
+            a.take(buffer.front());
+            buffer.removeFront();
+            count--;
+        }
+        // Blocked pushers hold the next values in order: into this
+        // batch first, then into the freed buffer space.
+        while (!pushers.empty() && (a.got < a.max || count < capacity)) {
+            PushAwaiter* p = pushers.front();
+            pushers.pop_front();
+            if (a.got < a.max) {
+                a.take(p->value);
+            } else {
+                buffer.addBack(p->value);
+                count++;
+            }
+            executor.schedule(p->waiting);
+        }
+        if (a.got > 0 || closed) return false;
+        poppers.push_back({&a, [](void* w, int v) { static_cast<PopAwaiter<Batch>*>(w)->take(v); }, h});
+        return true;
+    }
+
+public:
+    Channel(Executor& e, int capacity): executor(e), capacity(capacity < 0 ? 0 : capacity) {}
+    Channel(const Channel&) = delete;
+    Channel& operator=(const Channel&) = delete;
+
+    PushAwaiter push_back(int value) { return {*this, value}; }
+    PopAwaiter<false> pop_front() { return {*this, 1}; }
+    PopAwaiter<true> pop_front(int max) { return {*this, max < 1 ? 1 : max}; }
+
+    // No more pushes; waiting pushers get false, waiting poppers wake
+    // with nothing. Whatever is buffered can still be popped.
+    void close() {
+        std::lock_guard<std::mutex> guard(lock);
+        closed = true;
+        for (PushAwaiter* p : pushers) {
+            p->ok = false;
+            executor.schedule(p->waiting);
+        }
+        pushers.clear();
+        for (Popper& p : poppers) executor.schedule(p.waiting);
+        poppers.clear();
+    }
+
+    int size() {
+        std::lock_guard<std::mutex> guard(lock);
+        return count;
+    }
+};
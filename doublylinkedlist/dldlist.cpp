@@ -1,21 +1,191 @@
+#include <algorithm>
+#include <climits>
 #include <iostream>
 #include "dldlist.h"
+#include "../common/valueset.h"
 using namespace std;
 
+using Walk = ChainWalker<Node>;
 
-DoublyLinkedList::DoublyLinkedList() {
-    header = new Node;
-    trailer = new Node;
-    header->next = trailer;
-    trailer->prev = header;
+
+DoublyLinkedList::DoublyLinkedList(): DoublyLinkedList(NodeStorage::Heap) {}
+
+DoublyLinkedList::DoublyLinkedList(NodeStorage storage): local(storage) {
+    use(&local);
+}
+
+DoublyLinkedList::DoublyLinkedList(const DoublyLinkedList& other): local(other.local.nodes.mode()) {
+    if (other.inTransaction()) {
+        // Its nodes may still be rolled back under a sharer
+        copyToLocal(other.header->next, other.trailer);
+        use(&local);
+        return;
+    }
+    other.share();
+    other.shared->refs.fetch_add(1, memory_order_relaxed);
+    use(other.shared);
+}
+
+DoublyLinkedList& DoublyLinkedList::operator=(const DoublyLinkedList& other) {
+    if (shared == other.shared) return *this;
+    settle();
+    rangesStale = true;
+    if (other.inTransaction()) {
+        release();
+        copyToLocal(other.header->next, other.trailer);
+        use(&local);
+        return *this;
+    }
+    other.share();
+    other.shared->refs.fetch_add(1, memory_order_relaxed);
+    release();
+    use(other.shared);
+    return *this;
 }
 
 DoublyLinkedList::~DoublyLinkedList() {
-    while (header) {
-        Node* tmp = header;
-        header = header->next;
-        delete tmp;
+    settle();
+    release();
+}
+
+void DoublyLinkedList::use(SharedChain* chain) const {
+    shared = chain;
+    header = &chain->header;
+    trailer = &chain->trailer;
+    compactAt = nullptr;
+}
+
+// Moves the local chain to the heap so copies can share it. Heap and
+// pooled nodes stay where they are; only the inline ones are copied.
+void DoublyLinkedList::share() const {
+    if (shared != &local) return;
+    SharedChain* own = new SharedChain(local.nodes.mode());
+    own->nodes.adopt(local.nodes);
+    Node* last = &own->header;
+    Node* mover = local.header.next;
+    while (mover != &local.trailer) {
+        Node* next = mover->next;
+        Node* moved = own->nodes.takeOver(local.nodes, mover);
+        moved->prev = last;
+        last->next = moved;
+        last = moved;
+        mover = next;
+    }
+    last->next = &own->trailer;
+    own->trailer.prev = last;
+    local.unlink();
+    use(own);
+}
+
+// Drops this list's share of the nodes; the last owner frees them.
+void DoublyLinkedList::release() {
+    if (shared != &local && shared->refs.fetch_sub(1, memory_order_acq_rel) != 1) return;
+    if (header->next != trailer) {
+        trailer->prev->next = nullptr;
+        shared->nodes.dropChain(header->next);
+    }
+    if (shared == &local) local.unlink();
+    else delete shared;
+}
+
+// Gives this list its own nodes before a mutation, back in the local
+// chain. Unshared lists are left alone, so only the first write after
+// a copy pays O(n).
+void DoublyLinkedList::detach() {
+    if (shared == &local || shared->refs.load(memory_order_acquire) == 1) return;
+    copyToLocal(header->next, trailer);
+    release();
+    use(&local);
+}
+
+// Fills the (empty) local chain with copies of [first, end).
+void DoublyLinkedList::copyToLocal(const Node* first, const Node* end) {
+    Node* last = &local.header;
+    for (const Node* mover = first; mover != end; mover = mover->next) {
+        Node* copy = local.nodes.create();
+        copy->value = mover->value;
+        copy->prev = last;
+        last->next = copy;
+        last = copy;
+    }
+    last->next = &local.trailer;
+    local.trailer.prev = last;
+}
+
+// Frees an unlinked node, or parks it for rollback(). A parked node
+// keeps its prev/next: undoing the later changes first restores those
+// neighbours, so relinking it is two stores.
+void DoublyLinkedList::discard(Node* v) {
+    if (inTransaction()) undo.push_back({v, false});
+    else shared->nodes.destroy(v);
+}
+
+void DoublyLinkedList::begin() {
+    marks.push_back(undo.size());
+}
+
+void DoublyLinkedList::commit() {
+    if (marks.empty()) return;
+    marks.pop_back();
+    if (marks.empty()) settle();
+}
+
+// Closes every open transaction, keeping the changes.
+void DoublyLinkedList::settle() {
+    marks.clear();
+    for (const Change& c : undo) {
+        if (!c.added) shared->nodes.destroy(c.node);
+    }
+    undo.clear(); // keeps its capacity for the next batch
+}
+
+void DoublyLinkedList::rollback() {
+    if (marks.empty()) return;
+    size_t mark = marks.back();
+    marks.pop_back();
+    if (undo.size() > mark) rangesStale = true;
+    while (undo.size() > mark) {
+        Change c = undo.back();
+        undo.pop_back();
+        Node* v = c.node;
+        if (c.added) {
+            if (v == compactAt) compactAt = nullptr;
+            v->prev->next = v->next;
+            v->next->prev = v->prev;
+            shared->nodes.destroy(v);
+        } else {
+            v->prev->next = v;
+            v->next->prev = v;
+        }
+    }
+    // Restored nodes may sit behind a compaction in progress
+    if (shared->nodes.relayingOut()) compactAt = nullptr;
+}
+
+bool DoublyLinkedList::inTransaction() const {
+    return !marks.empty();
+}
+
+// Drops this list's nodes (or its share of them) and starts over empty.
+void DoublyLinkedList::reset() {
+    settle();
+    release();
+    use(&local);
+    rangesStale = true;
+}
+
+FrozenIntList DoublyLinkedList::freeze() {
+    FrozenIntList::Builder frozen;
+    for (Node* mover = header->next; mover != trailer; mover = mover->next) {
+        frozen.add(mover->value);
     }
+    reset();
+    return frozen.finish();
+}
+
+void DoublyLinkedList::thaw(const FrozenIntList& frozen) {
+    reset();
+    frozen.forEach([this](int v) { add(trailer->prev, v); });
 }
 
 bool DoublyLinkedList::empty() const {
@@ -24,13 +194,18 @@ bool DoublyLinkedList::empty() const {
 
 int DoublyLinkedList::size() const {
     if (header->next == trailer) return 0;
+    // Walk in from both ends at once: two independent chains of loads
+    // keep two cache misses in flight instead of one.
     int count = 0;
-    Node* mover = header->next;
-    while (mover->next) {
-        count++;
-        mover = mover->next;
+    Node* left = header->next;
+    Node* right = trailer->prev;
+    while (true) {
+        if (left == right) return count + 1;
+        count += 2;
+        if (left->next == right) return count;
+        left = left->next;
+        right = right->prev;
     }
-    return count;
 }
 
 int DoublyLinkedList::front() const {
@@ -44,21 +219,92 @@ int DoublyLinkedList::back() const {
 }
 
 void DoublyLinkedList::addFront(int value) {
+    detach();
     add(header, value);
 }
 
 void DoublyLinkedList::addBack(int value) {
+    detach();
     add(trailer->prev, value);
 }
 
 void DoublyLinkedList::removeFront() {
+    if (empty()) return;
+    detach();
     remove(header->next);
 }
 
 void DoublyLinkedList::removeBack() {
+    if (empty()) return;
+    detach();
     remove(trailer->prev);
 }
 
+int DoublyLinkedList::removeAllOf(span<const int> values) {
+    if (empty() || values.empty()) return 0;
+    ValueSet filter(values);
+    return remove_if([&filter](int x) { return filter.contains(x); });
+}
+
+bool DoublyLinkedList::sharesWith(const DoublyLinkedList& other) const {
+    return shared == other.shared;
+}
+
+void DoublyLinkedList::reclaim() {
+    shared->nodes.reclaim();
+}
+
+bool DoublyLinkedList::clearStep(int budget) {
+    // Outside a transaction, since reset() would commit it
+    if (!inTransaction() && shared != &local && shared->refs.load(memory_order_acquire) > 1) {
+        reset(); // the other owners keep the nodes
+        return true;
+    }
+    if (!empty()) detach();
+    while (!empty() && budget > 0) {
+        remove(header->next);
+        budget--;
+    }
+    return empty();
+}
+
+void DoublyLinkedList::compact() {
+    settle();
+    detach();
+    if (!shared->nodes.relayingOut() && !empty()) {
+        shared->nodes.beginRelayout(size()); // one block for the whole list
+        compactAt = nullptr;
+    }
+    while (!compactStep(1 << 30)) {}
+}
+
+bool DoublyLinkedList::compactStep(int budget) {
+    settle();
+    detach();
+    if (!shared->nodes.relayingOut()) {
+        if (empty()) return true;
+        shared->nodes.beginRelayout(0);
+        compactAt = nullptr;
+    }
+    if (!compactAt) compactAt = header->next;
+    while (compactAt != trailer && budget > 0) {
+        Node* moved = shared->nodes.relocate(compactAt);
+        moved->prev->next = moved;
+        moved->next->prev = moved;
+        compactAt = moved->next;
+        budget--;
+    }
+    if (compactAt != trailer) return false;
+    shared->nodes.endRelayout();
+    compactAt = nullptr;
+    return true;
+}
+
+double DoublyLinkedList::fragmentation() const {
+    if (empty()) return 0.0;
+    return Walk::fragmentation(header->next, trailer);
+}
+
 bool DoublyLinkedList::isPalindrome() const {
     if (header->next == trailer) return true; // vacuously
 
@@ -74,18 +320,92 @@ bool DoublyLinkedList::isPalindrome() const {
     return true;
 }
 
+void DoublyLinkedList::buildIndex() {
+    if (!ranges) ranges = make_unique<RangeIndex>();
+    Node* mover = header->next;
+    ranges->assign(size(), [&mover] {
+        int value = mover->value;
+        mover = mover->next;
+        return value;
+    });
+    rangesStale = false;
+}
+
+void DoublyLinkedList::dropIndex() {
+    ranges.reset();
+}
+
+bool DoublyLinkedList::indexed() const {
+    return ranges && !rangesStale;
+}
+
+// The index while it is current, else nullptr.
+const RangeIndex* DoublyLinkedList::rangeIndex() const {
+    return indexed() ? ranges.get() : nullptr;
+}
+
+long long DoublyLinkedList::rangeSum(int i, int j) const {
+    if (const RangeIndex* index = rangeIndex()) return index->sum(i, j);
+    long long sum = 0;
+    int at = 0;
+    for (Node* mover = header->next; mover != trailer && at < j; mover = mover->next, at++) {
+        if (at >= i) sum += mover->value;
+    }
+    return sum;
+}
+
+int DoublyLinkedList::rangeMin(int i, int j) const {
+    if (const RangeIndex* index = rangeIndex()) return index->min(i, j);
+    int least = INT_MAX;
+    int at = 0;
+    for (Node* mover = header->next; mover != trailer && at < j; mover = mover->next, at++) {
+        if (at >= i) least = min(least, mover->value);
+    }
+    return least;
+}
+
+int DoublyLinkedList::rangeMax(int i, int j) const {
+    if (const RangeIndex* index = rangeIndex()) return index->max(i, j);
+    int most = INT_MIN;
+    int at = 0;
+    for (Node* mover = header->next; mover != trailer && at < j; mover = mover->next, at++) {
+        if (at >= i) most = max(most, mover->value);
+    }
+    return most;
+}
+
+int DoublyLinkedList::rangeCount(int i, int j, int value) const {
+    if (const RangeIndex* index = rangeIndex()) return index->countOf(i, j, value);
+    int count = 0;
+    int at = 0;
+    for (Node* mover = header->next; mover != trailer && at < j; mover = mover->next, at++) {
+        if (at >= i && mover->value == value) count++;
+    }
+    return count;
+}
+
 void DoublyLinkedList::add(Node* v, const int& value) {
     if (v == nullptr ||
         (v->next == nullptr && v->prev == nullptr) ||
         v == trailer
     ) return; // Actually, UB
 
-    Node* newNode = new Node;
+    Node* newNode = shared->nodes.create();
     newNode->value = value;
     newNode->next = v->next;
     newNode->prev = v;
     v->next->prev = newNode;
     v->next = newNode;
+    if (inTransaction()) undo.push_back({newNode, true});
+    if (ranges && !rangesStale) {
+        if (v == header) {
+            ranges->pushFront(value);
+        } else if (newNode->next == trailer) {
+            ranges->pushBack(value);
+        } else {
+            rangesStale = true;
+        }
+    }
 }
 
 void DoublyLinkedList::remove(Node* v) {
@@ -96,9 +416,19 @@ void DoublyLinkedList::remove(Node* v) {
         (v->next == nullptr && v->prev == nullptr)
     ) return; // Actually, UB
 
+    if (ranges && !rangesStale) {
+        if (v == header->next) {
+            ranges->popFront();
+        } else if (v == trailer->prev) {
+            ranges->popBack();
+        } else {
+            rangesStale = true;
+        }
+    }
+    if (v == compactAt) compactAt = nullptr;
     v->prev->next = v->next;
     v->next->prev = v->prev;
-    delete v;
+    discard(v);
 }
 
 void DoublyLinkedList::print() const {
@@ -1,5 +1,14 @@
 #pragma once
-
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+#include "../common/nodealloc.h"
+#include "../common/chainwalk.h"
+#include "../common/frozenlist.h"
+#include "rangeindex.h"
 
 class Node {
 private:
@@ -7,15 +16,74 @@ private:
     Node* prev {nullptr};
     Node* next {nullptr};
     friend class DoublyLinkedList;
+    friend struct SharedChain;
+    friend class NodeAllocator<Node>;
+    friend struct ChainWalker<Node>;
+};
+
+// What copies of a list share: the owner count, the sentinels and the
+// allocator the chain's nodes came from.
+struct SharedChain {
+    std::atomic<int> refs {1};
+    Node header;
+    Node trailer;
+    NodeAllocator<Node> nodes;
+    explicit SharedChain(NodeStorage storage): nodes(storage) {
+        unlink();
+    }
+    void unlink() {
+        header.next = &trailer;
+        trailer.prev = &header;
+    }
 };
 
 class DoublyLinkedList {
 private:
-    Node* header;
-    Node* trailer;
+    // The list's own chain, sentinels and first nodes inline, so short
+    // lists never touch the heap. Copies can't share something inside
+    // another list object, so the first copy moves it out to the heap
+    // (share()); copies then share that chain until one of them is
+    // mutated (copy-on-write), and a detaching list goes back to local.
+    // share() runs on the list being copied, hence the mutables; it
+    // also means one list can't be copied from two threads at once.
+    mutable SharedChain local;
+    mutable SharedChain* shared;
+    mutable Node* header;
+    mutable Node* trailer;
+    // Where compactStep() resumes; nullptr restarts from the front.
+    // Reset when that node is removed or moved to another list.
+    mutable Node* compactAt {nullptr};
+
+    // Undo log of the open transactions, oldest change first, and where
+    // each begin() started in it.
+    struct Change {
+        Node* node;
+        bool added; // otherwise it was unlinked and is parked
+    };
+    std::vector<Change> undo;
+    std::vector<std::size_t> marks;
+
+    // The range query index, if buildIndex() asked for one. Adds and
+    // removals at the ends keep it current; other changes mark it
+    // stale, and queries walk the list until buildIndex() rebuilds it.
+    std::unique_ptr<RangeIndex> ranges;
+    bool rangesStale {false};
+
+    void use(SharedChain* chain) const;
+    void share() const;
+    void detach();
+    void release();
+    void copyToLocal(const Node* first, const Node* end);
+    void discard(Node* v);
+    void settle();
+    void reset();
+    const RangeIndex* rangeIndex() const;
 
 public:
     DoublyLinkedList();
+    explicit DoublyLinkedList(NodeStorage storage);
+    DoublyLinkedList(const DoublyLinkedList& other); // O(1), shares nodes
+    DoublyLinkedList& operator=(const DoublyLinkedList& other);
     ~DoublyLinkedList();
 
     bool empty() const;
@@ -28,10 +96,135 @@ public:
     void removeFront();
     void removeBack();
 
+    // All return the number of nodes removed (or moved).
+    int removeAllOf(std::span<const int> values);
+    template <typename Pred> int remove_if(Pred pred);
+    // Keep the elements satisfying pred and relink the rest, in order,
+    // onto the back of `rest`. Both ends are O(1) here, so partition
+    // is the same as stable_partition.
+    template <typename Pred> int stable_partition(Pred pred, DoublyLinkedList& rest);
+    template <typename Pred> int partition(Pred pred, DoublyLinkedList& rest);
+
     bool isPalindrome() const;
     void print() const;
 
+    // Queries over positions [i, j), clamped to the list. Without an
+    // index they walk from the front; buildIndex() builds one in O(n)
+    // that makes them O(log n) for the list's lifetime (copies don't
+    // inherit it) at the price of an O(log n) update per add or removal
+    // at either end. Changes in the middle (remove_if, partitions,
+    // rollback, thaw, ...) put the queries back on walks until
+    // buildIndex() is called again; indexed() says which they use.
+    // The queries never write, not even to the index, so any number of
+    // threads may run them at once while nothing changes the list.
+    void buildIndex();
+    void dropIndex();
+    bool indexed() const;
+    long long rangeSum(int i, int j) const;
+    int rangeMin(int i, int j) const; // INT_MAX over an empty range
+    int rangeMax(int i, int j) const; // INT_MIN over an empty range
+    int rangeCount(int i, int j, int value) const;
+
+    // Frees nodes parked by the Deferred/Background storage modes.
+    void reclaim();
+
+    // Latency-bounded teardown: frees at most `budget` nodes from the
+    // front per call and returns true once the list is empty, valid all
+    // along. Outside a transaction, a list sharing its nodes with copies
+    // just lets go of them.
+    // Call it until done before dropping a huge list.
+    bool clearStep(int budget);
+
+    // Moves the nodes into contiguous list-owned blocks in list order
+    // (the list uses Pool storage afterwards). compactStep() moves at
+    // most `budget` nodes per call and returns true once it is done.
+    void compact();
+    bool compactStep(int budget);
+    double fragmentation() const; // 0 = contiguous, 1 = every hop far away
+
+    // True when both lists still share the same nodes.
+    bool sharesWith(const DoublyLinkedList& other) const;
+
+    // For lists that go read-only: freeze() moves the values into a
+    // compressed FrozenIntList and leaves this list empty (copies keep
+    // theirs); thaw() replaces the contents with a frozen list's values.
+    // Both commit an open transaction.
+    FrozenIntList freeze();
+    void thaw(const FrozenIntList& frozen);
+
+    // Transactions: after begin(), every link and unlink is logged and
+    // removed nodes are parked instead of freed, so rollback() undoes
+    // the changes since the matching begin() in O(changes) and commit()
+    // keeps them. begin() nests; the outermost commit() frees the parked
+    // nodes in one pass. While one is open, copies of the list are deep.
+    // compact(), compactStep(), assignment and the destructor commit.
+    void begin();
+    void commit();
+    void rollback();
+    bool inTransaction() const;
+
 protected:
+    // Callers must detach() before handing in a node.
     void add(Node* v, const int& e);
     void remove(Node* v);
 };
+
+template <typename Pred>
+int DoublyLinkedList::remove_if(Pred pred) {
+    if (empty()) return 0;
+    detach();
+    int count = 0;
+    Node* mover = header->next;
+    while (mover != trailer) {
+        Node* next = mover->next;
+        if (pred(mover->value)) {
+            if (mover == compactAt) compactAt = nullptr;
+            mover->prev->next = next;
+            next->prev = mover->prev;
+            discard(mover);
+            count++;
+        }
+        mover = next;
+    }
+    if (count) rangesStale = true;
+    return count;
+}
+
+template <typename Pred>
+int DoublyLinkedList::stable_partition(Pred pred, DoublyLinkedList& rest) {
+    if (&rest == this || empty()) return 0;
+    detach();
+    rest.detach();
+    int moved = 0;
+    Node* mover = header->next;
+    while (mover != trailer) {
+        Node* next = mover->next;
+        if (!pred(mover->value)) {
+            if (mover == compactAt) compactAt = nullptr;
+            mover->prev->next = next;
+            next->prev = mover->prev;
+            // Nodes that can't change lists, and nodes parked for
+            // rollback(), are copied across
+            if (inTransaction() || !shared->nodes.movable(mover, rest.shared->nodes)) {
+                Node* copy = rest.shared->nodes.create();
+                copy->value = mover->value;
+                discard(mover);
+                mover = copy;
+            }
+            mover->prev = rest.trailer->prev;
+            mover->next = rest.trailer;
+            rest.trailer->prev->next = mover;
+            rest.trailer->prev = mover;
+            if (rest.inTransaction()) rest.undo.push_back({mover, true});
+            moved++;
+        }
+        mover = next;
+    }
+    if (moved) rangesStale = rest.rangesStale = true;
+    return moved;
+}
+
+template <typename Pred>
+int DoublyLinkedList::partition(Pred pred, DoublyLinkedList& rest) {
+    return stable_partition(pred, rest);
+}
@@ -0,0 +1,85 @@
+#include "executor.h"
+using namespace std;
+
+
+void Task::FinalAwaiter::await_suspend(Handle h) noexcept {
+    Executor* executor = h.promise().executor;
+    h.destroy();
+    executor->finished();
+}
+
+void Executor::spawn(Task task) {
+    Task::Handle h = task.handle;
+    task.handle = nullptr;
+    h.promise().executor = this;
+    running.fetch_add(1, memory_order_relaxed);
+    schedule(h);
+}
+
+void Executor::finished() {
+    if (running.fetch_sub(1, memory_order_acq_rel) == 1) idle();
+}
+
+
+void LoopExecutor::schedule(coroutine_handle<> h) {
+    ready.push_back(h);
+}
+
+int LoopExecutor::run() {
+    while (!ready.empty()) {
+        coroutine_handle<> h = ready.front();
+        ready.pop_front();
+        h.resume();
+    }
+    return tasks();
+}
+
+
+ThreadPoolExecutor::ThreadPoolExecutor(int threads) {
+    if (threads < 1) threads = 1;
+    for (int i = 0; i < threads; i++) {
+        workers.emplace_back([this] { work(); });
+    }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) t.join();
+}
+
+void ThreadPoolExecutor::schedule(coroutine_handle<> h) {
+    {
+        lock_guard<mutex> guard(lock);
+        ready.push_back(h);
+    }
+    wake.notify_one();
+}
+
+void ThreadPoolExecutor::work() {
+    while (true) {
+        coroutine_handle<> h;
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || !ready.empty(); });
+            if (ready.empty()) return; // stopping
+            h = ready.front();
+            ready.pop_front();
+        }
+        h.resume();
+    }
+}
+
+void ThreadPoolExecutor::idle() {
+    // Take the lock so wait() can't miss the notification
+    lock_guard<mutex> guard(lock);
+    done.notify_all();
+}
+
+void ThreadPoolExecutor::wait() {
+    unique_lock<mutex> guard(lock);
+    done.wait(guard, [this] { return tasks() == 0; });
+}
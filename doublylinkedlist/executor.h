@@ -0,0 +1,102 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Executor;
+
+// A coroutine that runs on an Executor. It starts suspended; hand it to
+// Executor::spawn() to run it. The frame frees itself when it finishes.
+class Task {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        void await_suspend(Handle h) noexcept;
+        void await_resume() noexcept {}
+    };
+
+    struct promise_type {
+        Executor* executor {nullptr};
+        Task get_return_object() { return Task(Handle::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    Task(Task&& other) noexcept: handle(other.handle) { other.handle = nullptr; }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle) handle.destroy(); // never spawned
+    }
+
+private:
+    Handle handle;
+    explicit Task(Handle h): handle(h) {}
+    friend class Executor;
+};
+
+// Runs coroutine handles. Channels hand woken coroutines back to the
+// executor instead of resuming them inline, so a push never runs the
+// consumer on the producer's stack.
+class Executor {
+private:
+    std::atomic<int> running {0};
+
+protected:
+    // Called once the last spawned task has finished.
+    virtual void idle() {}
+
+public:
+    virtual ~Executor() = default;
+    virtual void schedule(std::coroutine_handle<> h) = 0;
+
+    void spawn(Task task);
+    void finished(); // a spawned task ran to completion
+    int tasks() const { return running.load(std::memory_order_acquire); }
+};
+
+// Everything runs on the thread that calls run().
+class LoopExecutor : public Executor {
+private:
+    std::deque<std::coroutine_handle<>> ready;
+
+public:
+    void schedule(std::coroutine_handle<> h) override;
+    // Resumes ready coroutines until there are none. Returns the number
+    // of tasks still unfinished (blocked on something), 0 normally.
+    int run();
+};
+
+// A fixed set of worker threads sharing one ready queue.
+class ThreadPoolExecutor : public Executor {
+private:
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::deque<std::coroutine_handle<>> ready;
+    std::vector<std::thread> workers;
+    bool stopping {false};
+
+    void work();
+
+protected:
+    void idle() override;
+
+public:
+    explicit ThreadPoolExecutor(int threads);
+    ~ThreadPoolExecutor();
+
+    void schedule(std::coroutine_handle<> h) override;
+    // Blocks until every spawned task has finished.
+    void wait();
+};
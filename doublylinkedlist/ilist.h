@@ -0,0 +1,175 @@
+#pragma once
+#include <functional>
+#include <type_traits>
+
+// Intrusive counterpart of DoublyLinkedList: the caller's objects carry
+// the links, so linking and unlinking never allocate, and an object can
+// take itself off its list in O(1) without knowing which list that is.
+//
+//   struct Job : ListHook<> { int priority; };
+//   Job jobs[64];
+//   IntrusiveList<Job> ready;
+//   ready.addBack(jobs[3]);
+//   jobs[3].unlink();
+//
+// An object that sits on several lists at once derives from one hook
+// per list, told apart by tag types: struct Job : ListHook<Ready>,
+// ListHook<All> { ... } goes on IntrusiveList<Job, Ready> and
+// IntrusiveList<Job, All>.
+//
+// The list owns nothing: it never copies or frees its objects. An
+// object leaves its list when it is destroyed, and a list unlinks what
+// is still on it when it goes away. As in DoublyLinkedList, header and
+// trailer sentinels mean a linked hook's prev and next are never null.
+template <typename Tag = void>
+class ListHook {
+private:
+    ListHook* prev {nullptr};
+    ListHook* next {nullptr};
+    template <typename, typename> friend class IntrusiveList;
+
+public:
+    ListHook() = default;
+    // A copy is another object: it starts out on no list
+    ListHook(const ListHook&) {}
+    ListHook& operator=(const ListHook&) { return *this; }
+    ~ListHook() {
+        unlink();
+    }
+
+    bool linked() const {
+        return next != nullptr;
+    }
+
+    void unlink() {
+        if (!next) return;
+        prev->next = next;
+        next->prev = prev;
+        prev = next = nullptr;
+    }
+};
+
+template <typename T, typename Tag = void>
+class IntrusiveList {
+private:
+    using Hook = ListHook<Tag>;
+    static_assert(std::is_base_of<Hook, T>::value, "T must derive from ListHook<Tag>");
+
+    Hook header;
+    Hook trailer;
+
+    static Hook* hook(T& x) { return static_cast<Hook*>(&x); }
+    static T& object(Hook* h) { return *static_cast<T*>(h); }
+
+    // Puts h between the neighbours a and b, off whatever list it was on.
+    static void link(Hook* h, Hook* a, Hook* b) {
+        h->unlink();
+        h->prev = a;
+        h->next = b;
+        a->next = h;
+        b->prev = h;
+    }
+
+public:
+    IntrusiveList() {
+        header.next = &trailer;
+        trailer.prev = &header;
+    }
+    IntrusiveList(const IntrusiveList&) = delete;
+    IntrusiveList& operator=(const IntrusiveList&) = delete;
+    ~IntrusiveList() {
+        clear();
+        header.next = nullptr; // the sentinels are on no list either
+        trailer.prev = nullptr;
+    }
+
+    bool empty() const {
+        return header.next == &trailer;
+    }
+
+    // O(n): objects leave without telling the list.
+    int size() const {
+        int count = 0;
+        for (const Hook* h = header.next; h != &trailer; h = h->next) {
+            count++;
+        }
+        return count;
+    }
+
+    // Both UB on an empty list.
+    T& front() const { return object(header.next); }
+    T& back() const { return object(trailer.prev); }
+
+    // An object already on a list (this one or another with the same
+    // tag) moves here.
+    void addFront(T& x) { link(hook(x), &header, header.next); }
+    void addBack(T& x) { link(hook(x), trailer.prev, &trailer); }
+    // pos must be on this list.
+    void insertBefore(T& pos, T& x) { link(hook(x), hook(pos)->prev, hook(pos)); }
+    void insertAfter(T& pos, T& x) { link(hook(x), hook(pos), hook(pos)->next); }
+
+    void removeFront() {
+        if (!empty()) header.next->unlink();
+    }
+
+    void removeBack() {
+        if (!empty()) trailer.prev->unlink();
+    }
+
+    // Same as x.unlink(), which is ambiguous for objects with several hooks.
+    static void remove(T& x) {
+        hook(x)->unlink();
+    }
+
+    // Unlinks every object; O(n), since each hook has to be told.
+    void clear() {
+        Hook* h = header.next;
+        while (h != &trailer) {
+            Hook* next = h->next;
+            h->prev = h->next = nullptr;
+            h = next;
+        }
+        header.next = &trailer;
+        trailer.prev = &header;
+    }
+
+    // Calls visit(object) front to back. visit may unlink the object it
+    // is given, but no other.
+    template <typename F>
+    void forEach(F visit) const {
+        Hook* h = header.next;
+        while (h != &trailer) {
+            Hook* next = h->next;
+            visit(object(h));
+            h = next;
+        }
+    }
+
+    // Returns the number of objects unlinked.
+    template <typename Pred>
+    int remove_if(Pred pred) {
+        int removed = 0;
+        forEach([&](T& x) {
+            if (!pred(x)) return;
+            hook(x)->unlink();
+            removed++;
+        });
+        return removed;
+    }
+
+    // Walks in from both ends like DoublyLinkedList::isPalindrome(),
+    // comparing objects with same(a, b).
+    template <typename Eq = std::equal_to<>>
+    bool isPalindrome(Eq same = Eq()) const {
+        if (empty()) return true; // vacuously
+        Hook* left = header.next;
+        Hook* right = trailer.prev;
+        while (left != right) {
+            if (!same(object(left), object(right))) return false;
+            if (left->next == right) break;
+            left = left->next;
+            right = right->prev;
+        }
+        return true;
+    }
+};
@@ -0,0 +1,197 @@
+#include <algorithm>
+#include "rangeindex.h"
+using namespace std;
+
+static const RangeIndex::Summary none {0, INT_MAX, INT_MIN};
+
+static RangeIndex::Summary combine(const RangeIndex::Summary& a, const RangeIndex::Summary& b) {
+    return {a.sum + b.sum, std::min(a.min, b.min), std::max(a.max, b.max)};
+}
+
+
+RangeIndex::RangeIndex(): values(blockSize), mask(blockSize - 1), leaves(1), tree(2, none),
+                          sorted(blockSize), filled(1) {}
+
+int RangeIndex::size() const {
+    return count;
+}
+
+// Keeps the capacity.
+void RangeIndex::clear() {
+    first = 0;
+    count = 0;
+    fill(tree.begin(), tree.end(), none);
+    fill(filled.begin(), filled.end(), 0);
+}
+
+// Doubles the ring. Elements keep their tickets, so only their slots
+// (and with them the blocks) change.
+void RangeIndex::grow() {
+    int cap = (mask + 1) * 2;
+    vector<int> bigger(cap);
+    for (long long t = first; t < first + count; t++) bigger[t & (cap - 1)] = values[slot(t)];
+    values.swap(bigger);
+    mask = cap - 1;
+    leaves = cap / blockSize;
+    rebuildBlocks();
+}
+
+void RangeIndex::rebuildBlocks() {
+    tree.assign(2 * leaves, none);
+    sorted.resize(values.size());
+    filled.assign(leaves, 0);
+    for (int b = 0; b < leaves; b++) {
+        Summary& leaf = tree[leaves + b];
+        int* own = &sorted[b * blockSize];
+        for (int s = b * blockSize; s < (b + 1) * blockSize; s++) {
+            if (!occupied(s)) continue;
+            leaf = combine(leaf, {values[s], values[s], values[s]});
+            own[filled[b]++] = values[s];
+        }
+        sort(own, own + filled[b]);
+    }
+    for (int k = leaves - 1; k > 0; k--) tree[k] = combine(tree[2 * k], tree[2 * k + 1]);
+}
+
+void RangeIndex::raise(int block) {
+    for (int k = (leaves + block) / 2; k > 0; k /= 2) tree[k] = combine(tree[2 * k], tree[2 * k + 1]);
+}
+
+// Files x among the block's sorted values and folds it into the block
+// and each ancestor, no sibling reads needed.
+void RangeIndex::add(int block, int x) {
+    int* own = &sorted[block * blockSize];
+    int* end = own + filled[block]++;
+    int* at = upper_bound(own, end, x);
+    copy_backward(at, end, end + 1);
+    *at = x;
+    for (int k = leaves + block; k > 0; k /= 2) tree[k] = combine(tree[k], {x, x, x});
+}
+
+// x has left the block's slots already; here it leaves the sorted
+// values. If it was the block's min or max, the new ones are at the
+// ends of what is left and the ancestors are recomputed; otherwise it
+// was neither for any ancestor either, and only the sums change.
+void RangeIndex::removed(int block, int x) {
+    int* own = &sorted[block * blockSize];
+    int* end = own + filled[block]--;
+    int* at = lower_bound(own, end, x);
+    copy(at + 1, end, at);
+    Summary& leaf = tree[leaves + block];
+    if (x == leaf.min || x == leaf.max) {
+        leaf = filled[block] ? Summary {leaf.sum - x, own[0], own[filled[block] - 1]} : none;
+        raise(block);
+        return;
+    }
+    for (int k = leaves + block; k > 0; k /= 2) tree[k].sum -= x;
+}
+
+void RangeIndex::pushFront(int x) {
+    if (count > mask) grow();
+    first--;
+    values[slot(first)] = x;
+    count++;
+    add(slot(first) / blockSize, x);
+}
+
+void RangeIndex::pushBack(int x) {
+    if (count > mask) grow();
+    long long t = first + count;
+    values[slot(t)] = x;
+    count++;
+    add(slot(t) / blockSize, x);
+}
+
+void RangeIndex::popFront() {
+    long long t = first;
+    int x = values[slot(t)];
+    first++;
+    count--;
+    removed(slot(t) / blockSize, x);
+}
+
+void RangeIndex::popBack() {
+    long long t = first + count - 1;
+    int x = values[slot(t)];
+    count--;
+    removed(slot(t) / blockSize, x);
+}
+
+// Tickets [from, to), all in one block.
+RangeIndex::Summary RangeIndex::scan(long long from, long long to) const {
+    Summary s = none;
+    for (long long t = from; t < to; t++) {
+        int x = values[slot(t)];
+        s = combine(s, {x, x, x});
+    }
+    return s;
+}
+
+// Whole blocks [from, to), bottom-up through the tree.
+RangeIndex::Summary RangeIndex::blocks(int from, int to) const {
+    Summary s = none;
+    for (int l = from + leaves, r = to + leaves; l < r; l /= 2, r /= 2) {
+        if (l & 1) s = combine(s, tree[l++]);
+        if (r & 1) s = combine(s, tree[--r]);
+    }
+    return s;
+}
+
+// A range is a partial block, a run of whole blocks, and a partial
+// block; the run splits in two where it wraps round the ring.
+RangeIndex::Summary RangeIndex::summary(int i, int j) const {
+    i = std::max(i, 0);
+    j = std::min(j, count);
+    Summary s = none;
+    long long from = first + i;
+    long long to = first + j;
+    while (from < to) {
+        int at = slot(from);
+        int offset = at % blockSize;
+        if (offset != 0 || to - from < blockSize) {
+            long long n = std::min<long long>(to - from, blockSize - offset);
+            s = combine(s, scan(from, from + n));
+            from += n;
+        } else {
+            int run = int(std::min<long long>((to - from) / blockSize, leaves - at / blockSize));
+            s = combine(s, blocks(at / blockSize, at / blockSize + run));
+            from += (long long)run * blockSize;
+        }
+    }
+    return s;
+}
+
+long long RangeIndex::sum(int i, int j) const {
+    return summary(i, j).sum;
+}
+
+int RangeIndex::min(int i, int j) const {
+    return summary(i, j).min;
+}
+
+int RangeIndex::max(int i, int j) const {
+    return summary(i, j).max;
+}
+
+// Edges are scanned as in summary(); each whole block in between is
+// binary-searched.
+int RangeIndex::countOf(int i, int j, int x) const {
+    i = std::max(i, 0);
+    j = std::min(j, count);
+    int n = 0;
+    long long from = first + i;
+    long long to = first + j;
+    while (from < to) {
+        int at = slot(from);
+        if (at % blockSize != 0 || to - from < blockSize) {
+            n += values[at] == x;
+            from++;
+        } else {
+            const int* own = &sorted[at];
+            auto same = equal_range(own, own + blockSize, x);
+            n += int(same.second - same.first);
+            from += blockSize;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include <climits>
+#include <vector>
+
+// Range sum, min and max over positions [i, j) of an int sequence that
+// grows and shrinks at both ends, in O(log n) plus one block scan at
+// each edge of the range; count-of-value in O((j - i) / blockSize *
+// log blockSize) plus the same scans. DoublyLinkedList keeps one
+// alongside its nodes (buildIndex()); it is usable on its own too.
+//
+// Values sit in a power-of-two ring, so adds at the front shift
+// nothing, cut into blocks of blockSize slots; a segment tree over the
+// blocks holds each block's sum, min and max. Every element gets a
+// ticket, first + its position, which doesn't change while it is in
+// the sequence: front adds count down, back adds count up. Each block
+// also keeps its values sorted, so counting binary-searches every
+// whole block in the range; that costs 4 bytes a slot however many
+// distinct values there are, where per-value position lists cost
+// hundreds of bytes per distinct value.
+class RangeIndex {
+public:
+    static const int blockSize = 64;
+
+    struct Summary {
+        long long sum;
+        int min;  // INT_MAX over an empty range
+        int max;  // INT_MIN over an empty range
+    };
+
+private:
+    std::vector<int> values;
+    int mask;                 // capacity - 1, capacity a power of two >= blockSize
+    long long first {0};      // ticket of position 0
+    int count {0};
+    int leaves;               // blocks, a power of two
+    std::vector<Summary> tree; // node k has children 2k and 2k+1, block b is leaves + b
+    std::vector<int> sorted;  // block b's values, ascending, from slot b * blockSize
+    std::vector<int> filled;  // how many of block b's slots are occupied
+
+    int slot(long long ticket) const { return int(ticket & mask); }
+    bool occupied(int s) const { return ((s - slot(first)) & mask) < count; }
+    void grow();
+    void add(int block, int x);
+    void removed(int block, int x);
+    void raise(int block);
+    void rebuildBlocks();
+    Summary scan(long long from, long long to) const;
+    Summary blocks(int from, int to) const;
+
+public:
+    RangeIndex();
+    RangeIndex(const RangeIndex&) = delete;
+    RangeIndex& operator=(const RangeIndex&) = delete;
+
+    int size() const;
+    void clear();
+
+    // Replaces the contents with n values from next(), front to back, in
+    // O(n) rather than n pushBack()s' O(n log n).
+    template <typename Next> void assign(int n, Next next);
+
+    void pushFront(int x);
+    void pushBack(int x);
+    // Both UB on an empty index.
+    void popFront();
+    void popBack();
+
+    // [i, j) is clamped to [0, size()).
+    Summary summary(int i, int j) const;
+    long long sum(int i, int j) const;
+    int min(int i, int j) const;
+    int max(int i, int j) const;
+    int countOf(int i, int j, int x) const;
+};
+
+template <typename Next>
+void RangeIndex::assign(int n, Next next) {
+    clear();
+    while (mask + 1 < n) grow();
+    for (int i = 0; i < n; i++) values[i] = next();
+    count = n;
+    rebuildBlocks();
+}
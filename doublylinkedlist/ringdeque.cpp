@@ -0,0 +1,129 @@
+#include <iostream>
+#include <algorithm>
+#include <utility>
+#include "ringdeque.h"
+using namespace std;
+
+
+RingDeque::RingDeque(): RingDeque(16) {}
+
+RingDeque::RingDeque(int capacity): head(0), count(0) {
+    int cap = 1;
+    while (cap < capacity) cap <<= 1;
+    slots = new int[cap];
+    mask = cap - 1;
+}
+
+RingDeque::RingDeque(const RingDeque& other)
+    : slots(new int[other.mask + 1]), mask(other.mask), head(0), count(other.count) {
+    for (int i = 0; i < count; i++) slots[i] = other.at(i);
+}
+
+RingDeque::RingDeque(RingDeque&& other) noexcept
+    : slots(other.slots), mask(other.mask), head(other.head), count(other.count) {
+    other.slots = nullptr;
+    other.mask = -1; // capacity 0, the next add allocates
+    other.head = 0;
+    other.count = 0;
+}
+
+RingDeque& RingDeque::operator=(RingDeque other) {
+    swap(slots, other.slots);
+    swap(mask, other.mask);
+    swap(head, other.head);
+    swap(count, other.count);
+    return *this;
+}
+
+RingDeque::~RingDeque() {
+    delete[] slots;
+}
+
+// Doubles the buffer and unwraps the contents to start at slot 0.
+void RingDeque::grow() {
+    int cap = mask < 0 ? 16 : (mask + 1) * 2;
+    int* bigger = new int[cap];
+    for (int i = 0; i < count; i++) bigger[i] = at(i);
+    delete[] slots;
+    slots = bigger;
+    mask = cap - 1;
+    head = 0;
+}
+
+bool RingDeque::empty() const {
+    return count == 0;
+}
+
+int RingDeque::size() const {
+    return count;
+}
+
+int RingDeque::capacity() const {
+    return mask + 1;
+}
+
+int RingDeque::front() const {
+    if (count == 0) return -1; // same as DoublyLinkedList
+    return slots[head];
+}
+
+int RingDeque::back() const {
+    if (count == 0) return -1;
+    return at(count - 1);
+}
+
+void RingDeque::addFront(int value) {
+    if (count > mask) grow();
+    head = (head - 1) & mask;
+    slots[head] = value;
+    count++;
+}
+
+void RingDeque::addBack(int value) {
+    if (count > mask) grow();
+    slots[(head + count) & mask] = value;
+    count++;
+}
+
+void RingDeque::removeFront() {
+    if (count == 0) return;
+    head = (head + 1) & mask;
+    count--;
+}
+
+void RingDeque::removeBack() {
+    if (count == 0) return;
+    count--;
+}
+
+// Compares the front half against the back half in runs that don't
+// cross the end of the buffer. Inside a run there are no index masks
+// and no early exit, so the compiler can vectorize the comparison.
+bool RingDeque::isPalindrome() const {
+    int half = count / 2;
+    int i = 0;
+    while (i < half) {
+        int l = (head + i) & mask;
+        int r = (head + count - 1 - i) & mask;
+        int run = min({mask + 1 - l, r + 1, half - i});
+        const int* left = slots + l;
+        const int* right = slots + r;
+        int differ = 0;
+        for (int k = 0; k < run; k++) {
+            differ |= left[k] ^ right[-k];
+        }
+        if (differ) return false;
+        i += run;
+    }
+    return true;
+}
+
+void RingDeque::print() const {
+    if (count == 0) {
+        cout << "Empty.\n";
+    }
+    for (int i = 0; i < count; i++) {
+        cout << at(i) << " ";
+    }
+    cout << endl;
+}
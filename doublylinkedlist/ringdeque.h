@@ -0,0 +1,75 @@
+#pragma once
+#include <concepts>
+#include "dldlist.h"
+
+// DoublyLinkedList's queue API (both ends only) on a growable
+// power-of-two ring buffer. Elements sit in one array, so size() is
+// O(1) and isPalindrome() compares contiguous runs instead of chasing
+// pointers. No middle insertion, no copy-on-write: copies are deep.
+class RingDeque {
+private:
+    int* slots;
+    int mask;   // capacity - 1, capacity is a power of two
+    int head;   // slot of front()
+    int count;
+
+    int at(int i) const { return slots[(head + i) & mask]; }
+    void grow();
+
+public:
+    RingDeque();
+    explicit RingDeque(int capacity); // rounded up to a power of two
+    RingDeque(const RingDeque& other);
+    RingDeque(RingDeque&& other) noexcept;
+    RingDeque& operator=(RingDeque other);
+    ~RingDeque();
+
+    bool empty() const;
+    int size() const;
+    int capacity() const;
+    int front() const;
+    int back() const;
+    int operator[](int i) const { return at(i); } // from the front, unchecked
+
+    void addFront(int);
+    void addBack(int);
+    void removeFront();
+    void removeBack();
+
+    // Returns the number of elements removed; keeps the rest in order.
+    template <typename Pred> int remove_if(Pred pred);
+
+    bool isPalindrome() const;
+    void print() const;
+};
+
+template <typename Pred>
+int RingDeque::remove_if(Pred pred) {
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        int v = at(i);
+        if (!pred(v)) slots[(head + kept++) & mask] = v;
+    }
+    int removed = count - kept;
+    count = kept;
+    return removed;
+}
+
+// What queue-style code needs from a list. Write it against a
+// QueueBackend template parameter and pick DoublyLinkedList or
+// RingDeque at the call site.
+template <typename Q>
+concept QueueBackend = requires(Q q, const Q cq, int x) {
+    { cq.empty() } -> std::same_as<bool>;
+    { cq.size() } -> std::same_as<int>;
+    { cq.front() } -> std::same_as<int>;
+    { cq.back() } -> std::same_as<int>;
+    { cq.isPalindrome() } -> std::same_as<bool>;
+    q.addFront(x);
+    q.addBack(x);
+    q.removeFront();
+    q.removeBack();
+};
+
+static_assert(QueueBackend<DoublyLinkedList>);
+static_assert(QueueBackend<RingDeque>);
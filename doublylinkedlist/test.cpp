@@ -1,7 +1,32 @@
 #include <iostream>
 #include <cassert>
 #include <vector>
+#include <deque>
+#include <climits>
+#include <random>
+#include <numeric>
+#include <cstdlib>
+#include <new>
+#include <thread>
 #include "dldlist.h"
+#include "ringdeque.h"
+#include "channel.h"
+#include "worksteal.h"
+#include "ilist.h"
+
+// Counts heap allocations, so tests can check that a list made none.
+std::atomic<long long> allocations {0};
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // malloc'd above
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
 
 class TestRunner {
 private:
@@ -19,6 +44,10 @@ public:
         }
     }
     
+    int failures() const {
+        return failed;
+    }
+
     void summary() {
         std::cout << "\n=== Test Summary ===" << std::endl;
         std::cout << "Passed: " << passed << std::endl;
@@ -269,6 +298,970 @@ void test_large_operations(TestRunner& runner) {
     runner.test("Large ops - empty after removal", dll.empty());
 }
 
+// Reads a list passed by value
+int sum_by_value(DoublyLinkedList dll) {
+    int total = 0;
+    while (!dll.empty()) {
+        total += dll.front();
+        dll.removeFront(); // mutates the local copy only
+    }
+    return total;
+}
+
+// Test copy-on-write sharing between copies
+void test_copy_on_write(TestRunner& runner) {
+    DoublyLinkedList dll;
+    dll.addBack(1);
+    dll.addBack(2);
+    dll.addBack(3);
+
+    DoublyLinkedList copy(dll);
+    runner.test("COW - copy shares nodes", copy.sharesWith(dll));
+    runner.test("COW - copy reads the same", copy.size() == 3 && copy.front() == 1 && copy.back() == 3);
+
+    copy.addBack(4);
+    runner.test("COW - write detaches the copy", !copy.sharesWith(dll));
+    runner.test("COW - copy sees its write", copy.size() == 4 && copy.back() == 4);
+    runner.test("COW - original untouched", dll.size() == 3 && dll.back() == 3);
+
+    DoublyLinkedList assigned;
+    assigned.addFront(99);
+    assigned = dll;
+    runner.test("COW - assignment shares nodes", assigned.sharesWith(dll) && assigned.front() == 1);
+    assigned = assigned;
+    runner.test("COW - self assignment is harmless", assigned.size() == 3);
+
+    dll.removeFront();
+    runner.test("COW - original write detaches it", !dll.sharesWith(assigned));
+    runner.test("COW - other copy keeps old contents", assigned.front() == 1 && dll.front() == 2);
+
+    runner.test("COW - pass by value leaves caller intact",
+                sum_by_value(assigned) == 6 && assigned.size() == 3);
+
+    // Last owner frees the nodes, whichever one it is
+    DoublyLinkedList* heapList = new DoublyLinkedList;
+    heapList->addBack(7);
+    DoublyLinkedList survivor(*heapList);
+    delete heapList;
+    runner.test("COW - copy outlives the original", survivor.size() == 1 && survivor.front() == 7);
+
+    DoublyLinkedList palindrome;
+    palindrome.addBack(1);
+    palindrome.addBack(2);
+    palindrome.addBack(1);
+    DoublyLinkedList palCopy = palindrome;
+    palCopy.addBack(5);
+    runner.test("COW - palindrome check on each version",
+                palindrome.isPalindrome() && !palCopy.isPalindrome());
+}
+
+// Test batched removal and partitioning
+void test_remove_if_partition(TestRunner& runner) {
+    DoublyLinkedList dll;
+    for (int i = 0; i < 100; ++i) {
+        dll.addBack(i % 10);
+    }
+    int targets[] = {0, 2, 4, 6, 8};
+    int removed = dll.removeAllOf(targets);
+    runner.test("removeAllOf returns count", removed == 50);
+    runner.test("removeAllOf keeps the rest", dll.size() == 50 && dll.front() == 1 && dll.back() == 9);
+
+    DoublyLinkedList shared = dll;
+    removed = shared.remove_if([](int x) { return x > 4; });
+    runner.test("remove_if returns count", removed == 30);
+    runner.test("remove_if leaves 1s and 3s", shared.size() == 20 && shared.back() == 3);
+    runner.test("remove_if on a copy leaves the original", dll.size() == 50);
+
+    DoublyLinkedList empty;
+    runner.test("remove_if on empty list returns 0", empty.remove_if([](int) { return true; }) == 0);
+
+    DoublyLinkedList source;
+    for (int i = 1; i <= 6; ++i) {
+        source.addBack(i);
+    }
+    DoublyLinkedList rest;
+    rest.addBack(0);
+    int moved = source.stable_partition([](int x) { return x % 2 == 0; }, rest);
+    runner.test("stable_partition returns moved count", moved == 3);
+    runner.test("stable_partition keeps matches", source.size() == 3 && source.front() == 2 && source.back() == 6);
+    runner.test("stable_partition appends in order", rest.size() == 4 && rest.front() == 0 && rest.back() == 5);
+
+    DoublyLinkedList twin = rest;
+    moved = rest.partition([](int x) { return x > 0; }, twin);
+    runner.test("partition into a shared copy", moved == 1 && rest.size() == 3 && twin.size() == 5);
+}
+
+// Test the node storage / reclamation modes
+void test_storage_modes(TestRunner& runner) {
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Deferred,
+                           NodeStorage::Background, NodeStorage::Pool, NodeStorage::ThreadCache};
+    std::string names[] = {"Heap", "Deferred", "Background", "Pool", "ThreadCache"};
+
+    for (int m = 0; m < 5; ++m) {
+        DoublyLinkedList dll(modes[m]);
+        for (int i = 0; i < 10000; ++i) {
+            dll.addBack(i % 10);
+        }
+        int removed = dll.remove_if([](int x) { return x == 3; });
+        dll.removeFront();
+        dll.removeBack();
+        runner.test(names[m] + " - remove_if count", removed == 1000);
+        runner.test(names[m] + " - ends after removals", dll.size() == 8998 && dll.front() == 1 && dll.back() == 8);
+
+        // A copy detaches into the same storage mode
+        DoublyLinkedList copy = dll;
+        copy.addFront(42);
+        runner.test(names[m] + " - copy detaches", copy.front() == 42 && dll.front() == 1);
+
+        dll.reclaim();
+        for (int i = 0; i < 5000; ++i) {
+            dll.removeBack();
+        }
+        dll.addBack(7);
+        runner.test(names[m] + " - reuse after many removals", dll.size() == 3999 && dll.back() == 7);
+    }
+    Reclaimer::instance().drain();
+    runner.test("Background frees drain", true);
+}
+
+// Scrambles node order in memory by relinking
+void scramble(DoublyLinkedList& dll, int rounds) {
+    unsigned seed = 12345;
+    DoublyLinkedList rest;
+    for (int r = 0; r < rounds; ++r) {
+        dll.stable_partition([&seed](int) { seed = seed * 1103515245 + 12345; return (seed >> 16) & 1; }, rest);
+        rest.stable_partition([](int) { return false; }, dll);
+    }
+}
+
+// Test compaction and the fragmentation metric
+void test_compact(TestRunner& runner) {
+    DoublyLinkedList empty;
+    empty.compact();
+    runner.test("Compact empty list", empty.empty() && empty.fragmentation() == 0.0);
+
+    DoublyLinkedList dll;
+    for (int i = 0; i < 4000; ++i) {
+        dll.addBack(i % 100);
+    }
+    scramble(dll, 8);
+    int front = dll.front();
+    int back = dll.back();
+    runner.test("Scrambled list is fragmented", dll.fragmentation() > 0.5);
+
+    DoublyLinkedList copy = dll;
+    dll.compact();
+    runner.test("Compact keeps ends and size", dll.size() == 4000 && dll.front() == front && dll.back() == back);
+    runner.test("Compact makes the list contiguous", dll.fragmentation() == 0.0);
+    runner.test("Compact leaves a shared copy alone", !copy.sharesWith(dll) && copy.size() == 4000);
+
+    dll.removeFront();
+    dll.addBack(5);
+    runner.test("Compacted list still mutable", dll.size() == 4000 && dll.back() == 5);
+
+    DoublyLinkedList inc;
+    for (int i = 0; i < 3000; ++i) {
+        inc.addBack(1);
+    }
+    scramble(inc, 6);
+    int steps = 0;
+    while (!inc.compactStep(64)) {
+        ++steps;
+        if (steps % 4 == 0) inc.removeFront();
+        if (steps % 5 == 0) inc.addFront(1);
+    }
+    runner.test("compactStep takes several bounded steps", steps > 40);
+    runner.test("compactStep keeps a valid list", inc.isPalindrome() && inc.size() > 2900);
+    runner.test("compactStep leaves list mostly contiguous", inc.fragmentation() < 0.05);
+
+    {
+        DoublyLinkedList partial;
+        for (int i = 0; i < 1000; ++i) {
+            partial.addBack(i);
+        }
+        partial.compactStep(300);
+    }
+    runner.test("Destroying a list mid-compaction", true);
+
+    // Pooled nodes are copied, not relinked, across lists
+    DoublyLinkedList heap_side;
+    {
+        DoublyLinkedList pool_side(NodeStorage::Pool);
+        for (int i = 0; i < 100; ++i) {
+            pool_side.addBack(i);
+        }
+        pool_side.stable_partition([](int x) { return x < 50; }, heap_side);
+        heap_side.partition([](int x) { return x < 75; }, pool_side);
+    }
+    runner.test("Partition between pooled and heap lists", heap_side.size() == 25 && heap_side.front() == 50);
+}
+
+// Same queue ops on both backends; the ring buffer wraps and grows
+// many times along the way.
+template <QueueBackend Q>
+bool same_contents(Q& a, DoublyLinkedList& b) {
+    Q copy = a;
+    DoublyLinkedList other = b;
+    while (!copy.empty() && !other.empty()) {
+        if (copy.front() != other.front()) return false;
+        copy.removeFront();
+        other.removeFront();
+    }
+    return copy.empty() && other.empty();
+}
+
+void test_ring_deque(TestRunner& runner) {
+    RingDeque rd(4);
+    runner.test("RingDeque - starts empty", rd.empty() && rd.size() == 0);
+    runner.test("RingDeque - empty front/back return -1", rd.front() == -1 && rd.back() == -1);
+    runner.test("RingDeque - capacity rounded to power of two", RingDeque(5).capacity() == 8);
+
+    rd.addBack(2);
+    rd.addFront(1);
+    rd.addBack(3);
+    rd.addFront(0);
+    rd.addBack(4); // forces a grow while wrapped
+    runner.test("RingDeque - grows past capacity", rd.size() == 5 && rd.capacity() == 8);
+    runner.test("RingDeque - order kept across grow", rd.front() == 0 && rd.back() == 4);
+
+    std::mt19937 rng(7);
+    RingDeque ring;
+    DoublyLinkedList dll;
+    bool agree = true;
+    for (int i = 0; i < 20000; ++i) {
+        int op = rng() % 6;
+        int v = rng() % 8;
+        if (op < 2) { ring.addFront(v); dll.addFront(v); }
+        else if (op < 4) { ring.addBack(v); dll.addBack(v); }
+        else if (op == 4) { ring.removeFront(); dll.removeFront(); }
+        else { ring.removeBack(); dll.removeBack(); }
+        agree = agree && ring.size() == dll.size() &&
+                ring.front() == dll.front() && ring.back() == dll.back();
+    }
+    runner.test("RingDeque - matches DoublyLinkedList on random ops", agree);
+    runner.test("RingDeque - same contents", same_contents(ring, dll));
+
+    int removed = ring.remove_if([](int x) { return x % 3 == 0; });
+    int removed_dll = dll.remove_if([](int x) { return x % 3 == 0; });
+    runner.test("RingDeque - remove_if count", removed == removed_dll);
+    runner.test("RingDeque - remove_if keeps order", same_contents(ring, dll));
+
+    // Palindromes that straddle the end of the buffer
+    bool palindromes = true;
+    for (int shift = 0; shift < 16; ++shift) {
+        RingDeque p(16);
+        for (int i = 0; i < shift; ++i) p.addFront(99);
+        for (int i = 0; i < shift; ++i) p.removeBack();
+        for (int i = 0; i < 7; ++i) p.addBack(i);
+        for (int i = 6; i >= 0; --i) p.addBack(i);
+        palindromes = palindromes && p.isPalindrome() && p.size() == 14;
+        p.addBack(5);
+        palindromes = palindromes && !p.isPalindrome();
+    }
+    runner.test("RingDeque - palindrome at every wrap offset", palindromes);
+    runner.test("RingDeque - empty is palindrome", RingDeque().isPalindrome());
+
+    RingDeque copy = rd;
+    copy.removeFront();
+    runner.test("RingDeque - copies are independent", rd.front() == 0 && copy.front() == 1);
+    RingDeque moved = std::move(copy);
+    runner.test("RingDeque - move keeps contents", moved.size() == 4 && moved.front() == 1);
+    copy.addBack(5); // moved-from is empty but usable
+    runner.test("RingDeque - moved-from is reusable", copy.size() == 1 && copy.front() == 5);
+}
+
+// Coroutines for test_channel. Parameters are references to objects
+// that outlive the executor run.
+Task produce(Channel<>& ch, int from, int to, bool close_after) {
+    for (int v = from; v < to; ++v) {
+        co_await ch.push_back(v);
+    }
+    if (close_after) ch.close();
+}
+
+Task consume(Channel<>& ch, std::vector<int>& seen) {
+    while (auto v = co_await ch.pop_front()) {
+        seen.push_back(*v);
+    }
+}
+
+Task consume_batches(Channel<RingDeque>& ch, int max, std::vector<int>& seen, int& resumptions) {
+    while (true) {
+        std::vector<int> batch = co_await ch.pop_front(max);
+        if (batch.empty()) break;
+        resumptions++;
+        seen.insert(seen.end(), batch.begin(), batch.end());
+    }
+}
+
+Task produce_ring(Channel<RingDeque>& ch, int n) {
+    for (int v = 0; v < n; ++v) co_await ch.push_back(v);
+    ch.close();
+}
+
+Task push_after_close(Channel<>& ch, bool& ok) {
+    ok = co_await ch.push_back(1);
+}
+
+Task sum_into(Channel<>& ch, std::atomic<long long>& total) {
+    while (true) {
+        std::vector<int> batch = co_await ch.pop_front(32);
+        if (batch.empty()) break;
+        long long s = 0;
+        for (int v : batch) s += v;
+        total += s;
+    }
+}
+
+bool in_order(const std::vector<int>& seen, int n) {
+    if (int(seen.size()) != n) return false;
+    for (int i = 0; i < n; ++i) {
+        if (seen[i] != i) return false;
+    }
+    return true;
+}
+
+void test_channel(TestRunner& runner) {
+    for (int capacity : {0, 1, 4, 1000}) {
+        LoopExecutor loop;
+        Channel<> ch(loop, capacity);
+        std::vector<int> seen;
+        loop.spawn(consume(ch, seen));
+        loop.spawn(produce(ch, 0, 500, true));
+        int left = loop.run();
+        runner.test("Channel - capacity " + std::to_string(capacity) + " delivers in order",
+                    left == 0 && in_order(seen, 500));
+    }
+
+    {
+        // Producer runs ahead until the buffer is full, then waits
+        LoopExecutor loop;
+        Channel<> ch(loop, 8);
+        loop.spawn(produce(ch, 0, 100, false));
+        int left = loop.run();
+        runner.test("Channel - backpressure stops the producer at capacity", left == 1 && ch.size() == 8);
+        ch.close();
+        left = loop.run();
+        runner.test("Channel - close releases a blocked producer", left == 0);
+    }
+
+    {
+        LoopExecutor loop;
+        Channel<RingDeque> ch(loop, 64);
+        std::vector<int> seen;
+        int resumptions = 0;
+        loop.spawn(produce_ring(ch, 1000));
+        loop.spawn(consume_batches(ch, 50, seen, resumptions));
+        loop.run();
+        runner.test("Channel - batch pops keep order", in_order(seen, 1000));
+        runner.test("Channel - batch pops take several per resumption", resumptions < 100);
+    }
+
+    {
+        LoopExecutor loop;
+        Channel<> ch(loop, 4);
+        ch.close();
+        bool ok = true;
+        std::vector<int> seen;
+        loop.spawn(push_after_close(ch, ok));
+        loop.spawn(consume(ch, seen));
+        loop.run();
+        runner.test("Channel - push after close fails", !ok);
+        runner.test("Channel - pop after close returns nothing", seen.empty());
+    }
+
+    {
+        // Several producers and consumers on a real pool
+        std::atomic<long long> total {0};
+        long long expected = 0;
+        {
+            ThreadPoolExecutor pool(4);
+            Channel<> ch(pool, 16);
+            for (int c = 0; c < 3; ++c) pool.spawn(sum_into(ch, total));
+            for (int p = 0; p < 4; ++p) {
+                pool.spawn(produce(ch, p * 10000, (p + 1) * 10000, false));
+            }
+            for (int v = 0; v < 40000; ++v) expected += v;
+            while (pool.tasks() > 3) std::this_thread::yield(); // producers done
+            ch.close();
+            pool.wait();
+        }
+        runner.test("Channel - thread pool pipeline sums every value", total == expected);
+    }
+}
+
+struct CountJob : Job {
+    std::vector<std::atomic<int>>& hits;
+    int id;
+    CountJob(std::vector<std::atomic<int>>& h, int i): hits(h), id(i) {}
+    void run(int) override { hits[id]++; }
+};
+
+void test_work_stealing(TestRunner& runner) {
+    {
+        ChaseLevDeque dq(2); // grows
+        std::vector<std::atomic<int>> hits(10);
+        std::vector<CountJob> jobs;
+        for (int i = 0; i < 10; ++i) jobs.emplace_back(hits, i);
+        for (CountJob& j : jobs) dq.addBack(&j);
+        runner.test("ChaseLevDeque - removeBack is LIFO", dq.removeBack() == &jobs[9]);
+        runner.test("ChaseLevDeque - removeFront takes the oldest", dq.removeFront() == &jobs[0]);
+        int left = 0;
+        while (dq.removeBack()) ++left;
+        runner.test("ChaseLevDeque - drains the rest", left == 8 && dq.empty());
+        runner.test("ChaseLevDeque - empty returns nullptr", !dq.removeFront() && !dq.removeBack());
+    }
+
+    {
+        // Owner pushes and pops while thieves steal: every job runs once
+        const int n = 100000;
+        ChaseLevDeque dq(16);
+        std::vector<std::atomic<int>> hits(n);
+        std::vector<CountJob> jobs;
+        jobs.reserve(n);
+        for (int i = 0; i < n; ++i) jobs.emplace_back(hits, i);
+        std::atomic<bool> done {false};
+        std::vector<std::thread> thieves;
+        for (int t = 0; t < 3; ++t) {
+            thieves.emplace_back([&] {
+                while (!done.load()) {
+                    if (Job* j = dq.removeFront()) j->run(0);
+                    else std::this_thread::yield();
+                }
+            });
+        }
+        for (int i = 0; i < n; ++i) {
+            dq.addBack(&jobs[i]);
+            if (i % 3 == 0) {
+                if (Job* j = dq.removeBack()) j->run(0);
+            }
+        }
+        while (Job* j = dq.removeBack()) j->run(0);
+        while (!dq.empty()) std::this_thread::yield();
+        done = true;
+        for (std::thread& t : thieves) t.join();
+        bool once = true;
+        for (auto& h : hits) once = once && h.load() == 1;
+        runner.test("ChaseLevDeque - concurrent steals run each job once", once);
+    }
+
+    WorkStealingPool pool(4);
+    std::vector<std::atomic<int>> seen(100000);
+    pool.parallel_for(0, 100000, 64, [&](int lo, int hi) {
+        for (int i = lo; i < hi; ++i) seen[i]++;
+    });
+    bool each_once = true;
+    for (auto& s : seen) each_once = each_once && s.load() == 1;
+    runner.test("parallel_for - covers every index once", each_once);
+
+    RingDeque rd;
+    long long expected = 0;
+    for (int i = 0; i < 200000; ++i) {
+        rd.addBack(i % 1000);
+        expected += i % 1000;
+    }
+    long long total = pool.parallel_reduce(0, rd.size(), 1000, 0LL,
+        [&](int lo, int hi) {
+            long long s = 0;
+            for (int i = lo; i < hi; ++i) s += rd[i];
+            return s;
+        },
+        [](long long a, long long b) { return a + b; });
+    runner.test("parallel_reduce - sum over a RingDeque", total == expected);
+
+    RingDeque pal;
+    for (int i = 0; i < 50000; ++i) pal.addBack(i % 7);
+    for (int i = 49999; i >= 0; --i) pal.addBack(i % 7);
+    auto mirrored = [](const RingDeque& d, WorkStealingPool& p) {
+        int n = d.size();
+        return p.parallel_reduce(0, n / 2, 512, true,
+            [&](int lo, int hi) {
+                bool same = true;
+                for (int i = lo; i < hi; ++i) same &= d[i] == d[n - 1 - i];
+                return same;
+            },
+            [](bool a, bool b) { return a && b; });
+    };
+    bool yes = mirrored(pal, pool);
+    pal.addBack(3);
+    runner.test("parallel_reduce - isPalindrome", yes && !mirrored(pal, pool));
+
+    // Nested calls from inside jobs
+    long long nested = pool.parallel_reduce(0, 16, 1, 0LL,
+        [&](int lo, int hi) {
+            long long s = 0;
+            for (int i = lo; i < hi; ++i) {
+                s += pool.parallel_reduce(0, 1000, 50, 0LL,
+                    [](int a, int b) { return (long long)(b - a); },
+                    [](long long a, long long b) { return a + b; });
+            }
+            return s;
+        },
+        [](long long a, long long b) { return a + b; });
+    runner.test("parallel_reduce - nested calls", nested == 16000);
+
+    WorkStealingPool single(1);
+    int count = single.parallel_reduce(0, 1000, 10, 0,
+        [](int lo, int hi) { return hi - lo; },
+        [](int a, int b) { return a + b; });
+    runner.test("WorkStealingPool - one thread runs everything itself", count == 1000);
+}
+
+void test_inline_nodes(TestRunner& runner) {
+    // Allocation counts are taken before runner.test(), whose name
+    // strings allocate too
+    long long before = allocations;
+    bool works;
+    {
+        DoublyLinkedList dll;
+        for (int i = 0; i < listInlineNodes; ++i) dll.addBack(i);
+        dll.removeFront();
+        dll.addFront(-1);
+        dll.remove_if([](int x) { return x % 2 == 0; });
+        dll.addBack(7);
+        works = dll.front() == -1 && dll.back() == 7 && dll.size() == 10;
+    }
+    long long made = allocations - before;
+    runner.test("Inline - short list works", works);
+    runner.test("Inline - short list never allocates", made == 0);
+
+    before = allocations;
+    DoublyLinkedList dll;
+    for (int i = 0; i < listInlineNodes + 4; ++i) dll.addBack(i);
+    made = allocations - before;
+    runner.test("Inline - spills past the inline nodes", made == 4);
+
+    before = allocations;
+    DoublyLinkedList copy(dll);
+    made = allocations - before;
+    runner.test("Inline - first copy moves the chain out once", made == 1);
+    runner.test("Inline - moved chain is shared and intact",
+                copy.sharesWith(dll) && dll.size() == 20 && dll.front() == 0 && dll.back() == 19);
+
+    before = allocations;
+    DoublyLinkedList second(dll);
+    made = allocations - before;
+    runner.test("Inline - later copies just share", made == 0 && second.sharesWith(copy));
+
+    DoublyLinkedList small;
+    small.addBack(1);
+    small.addBack(2);
+    DoublyLinkedList small_copy(small);
+    before = allocations;
+    small_copy.addBack(3);
+    made = allocations - before;
+    runner.test("Inline - detaching a short copy goes back inline", made == 0);
+    runner.test("Inline - both versions correct",
+                small.size() == 2 && small_copy.size() == 3 && !small.sharesWith(small_copy));
+
+    // Inline nodes are copied, heap nodes relinked, across partitions
+    DoublyLinkedList evens(NodeStorage::Pool);
+    int moved = dll.stable_partition([](int x) { return x % 2 == 1; }, evens);
+    runner.test("Inline - partition across lists", moved == 10 && evens.front() == 0 && evens.back() == 18);
+    dll.compact();
+    runner.test("Inline - compact moves everything into blocks", dll.fragmentation() == 0.0 && dll.size() == 10);
+}
+
+// Front-to-back values, read off a copy
+std::vector<int> contents(DoublyLinkedList dll) {
+    std::vector<int> values;
+    while (!dll.empty()) {
+        values.push_back(dll.front());
+        dll.removeFront();
+    }
+    return values;
+}
+
+// Test begin/commit/rollback
+void test_transactions(TestRunner& runner) {
+    DoublyLinkedList dll;
+    for (int i = 0; i < 40; ++i) dll.addBack(i % 5);
+    std::vector<int> before = contents(dll);
+
+    dll.begin();
+    runner.test("Txn - begin opens a transaction", dll.inTransaction());
+    dll.addFront(100);
+    dll.addBack(200);
+    dll.removeBack();
+    dll.removeBack();
+    dll.removeFront();
+    dll.removeFront();
+    int removed = dll.remove_if([](int x) { return x == 2; });
+    dll.addBack(300);
+    runner.test("Txn - changes are visible inside", removed == 8 && dll.front() == 1 && dll.back() == 300);
+    dll.rollback();
+    runner.test("Txn - rollback restores the list", contents(dll) == before && !dll.inTransaction());
+
+    dll.begin();
+    dll.remove_if([](int x) { return x > 1; });
+    dll.addFront(-1);
+    dll.commit();
+    runner.test("Txn - commit keeps the changes", dll.size() == 17 && dll.front() == -1 && dll.back() == 1);
+    dll.rollback();
+    runner.test("Txn - rollback without begin does nothing", dll.size() == 17);
+
+    // Savepoints
+    dll.begin();
+    dll.addBack(7);
+    dll.begin();
+    dll.addBack(8);
+    dll.removeFront();
+    dll.rollback();
+    runner.test("Txn - inner rollback to the savepoint", dll.back() == 7 && dll.front() == -1 && dll.inTransaction());
+    dll.begin();
+    dll.addBack(9);
+    dll.commit();
+    dll.rollback();
+    runner.test("Txn - outer rollback undoes committed inner work", dll.size() == 17 && dll.back() == 1);
+
+    // Copies during a transaction don't share nodes that may roll back
+    DoublyLinkedList shared_before = dll;
+    dll.begin();
+    dll.addBack(5);
+    DoublyLinkedList copy = dll;
+    dll.rollback();
+    runner.test("Txn - copy taken inside keeps its contents", copy.size() == 18 && copy.back() == 5);
+    runner.test("Txn - a copy from before is untouched", shared_before.size() == 17 && dll.size() == 17);
+
+    // Partition: moved nodes are copied out and parked here
+    DoublyLinkedList rest;
+    rest.addBack(42);
+    dll.begin();
+    int moved = dll.stable_partition([](int x) { return x != 0; }, rest);
+    runner.test("Txn - partition inside a transaction", moved == 8 && dll.size() == 9 && rest.size() == 9);
+    dll.rollback();
+    runner.test("Txn - rollback restores the source only", dll.size() == 17 && rest.size() == 9);
+    rest.begin();
+    rest.stable_partition([](int x) { return x == 42; }, dll);
+    rest.addBack(43);
+    rest.rollback();
+    runner.test("Txn - destination rollback drops what came in", rest.size() == 9 && rest.back() == 0 && dll.size() == 25);
+
+    // Every storage mode, with and without a compaction under way
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Deferred,
+                           NodeStorage::Background, NodeStorage::Pool, NodeStorage::ThreadCache};
+    bool all_restored = true;
+    for (NodeStorage mode : modes) {
+        DoublyLinkedList big(mode);
+        for (int i = 0; i < 3000; ++i) big.addBack(i);
+        std::vector<int> original = contents(big);
+        for (int step = 0; step < 2; ++step) {
+            if (step == 1) big.compactStep(1000);
+            big.begin();
+            big.remove_if([](int x) { return x % 3 == 0; });
+            for (int i = 0; i < 500; ++i) big.addFront(-i);
+            for (int i = 0; i < 700; ++i) big.removeBack();
+            big.rollback();
+            all_restored = all_restored && contents(big) == original;
+        }
+        big.compact();
+        all_restored = all_restored && contents(big) == original;
+        big.begin();
+        big.removeFront();
+        // Destructor commits
+    }
+    Reclaimer::instance().drain();
+    runner.test("Txn - rollback in every storage mode", all_restored);
+}
+
+// Test freeze/thaw through FrozenIntList
+void test_freeze(TestRunner& runner) {
+    DoublyLinkedList dll;
+    for (int i = 0; i < 500; ++i) dll.addBack(i * 3);
+    for (int i = 499; i >= 0; --i) dll.addBack(i * 3);
+    std::vector<int> before = contents(dll);
+
+    DoublyLinkedList copy = dll;
+    FrozenIntList frozen = dll.freeze();
+    runner.test("Freeze - list left empty, copies keep theirs", dll.empty() && contents(copy) == before);
+    runner.test("Freeze - palindrome decoded from both ends", frozen.isPalindrome() && frozen.size() == 1000);
+    runner.test("Freeze - sorted runs compress", frozen.memory() < 1000 * 2 + 100);
+
+    dll.addBack(1);
+    dll.begin();
+    dll.addBack(2);
+    dll.thaw(frozen);
+    runner.test("Thaw - replaces the contents", contents(dll) == before && !dll.inTransaction());
+    dll.removeBack();
+    runner.test("Thaw - the list is mutable again", dll.size() == 999 && frozen.size() == 1000);
+
+    DoublyLinkedList pooled(NodeStorage::Pool);
+    pooled.thaw(frozen);
+    pooled.compact();
+    runner.test("Thaw - into pooled storage", contents(pooled) == before && !pooled.freeze().empty());
+}
+
+// Test per-thread node caches
+void test_thread_cache(TestRunner& runner) {
+    DoublyLinkedList warm(NodeStorage::ThreadCache);
+    for (int i = 0; i < 1000; ++i) warm.addBack(i);
+    for (int i = 0; i < 1000; ++i) warm.removeFront();
+    long long before = allocations;
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 1000; ++i) warm.addBack(i);
+        for (int i = 0; i < 1000; ++i) warm.removeFront();
+    }
+    long long made = allocations - before;
+    runner.test("ThreadCache - churn reuses cached nodes", made == 0 && warm.empty());
+
+    // Lists built on workers, freed here: nodes cross threads both ways
+    const int workers = 4;
+    std::vector<DoublyLinkedList*> built(workers);
+    std::vector<std::thread> threads;
+    for (int w = 0; w < workers; ++w) {
+        threads.emplace_back([&built, w] {
+            DoublyLinkedList* dll = new DoublyLinkedList(NodeStorage::ThreadCache);
+            for (int i = 0; i < 20000; ++i) dll->addBack(w);
+            for (int i = 0; i < 5000; ++i) dll->removeFront();
+            built[w] = dll;
+        });
+    }
+    for (std::thread& t : threads) t.join();
+    bool intact = true;
+    for (int w = 0; w < workers; ++w) {
+        intact = intact && built[w]->size() == 15000 && built[w]->front() == w;
+        built[w]->remove_if([](int) { return true; });
+        delete built[w];
+    }
+    runner.test("ThreadCache - lists outlive the threads that built them", intact);
+
+    // Heap and cached nodes don't mix: partitions copy between them
+    DoublyLinkedList cached(NodeStorage::ThreadCache);
+    DoublyLinkedList heap;
+    DoublyLinkedList other_cached(NodeStorage::ThreadCache);
+    for (int i = 0; i < 100; ++i) cached.addBack(i);
+    int moved = cached.stable_partition([](int x) { return x % 2 == 0; }, heap);
+    moved += cached.stable_partition([](int x) { return x % 4 == 0; }, other_cached);
+    runner.test("ThreadCache - partitions to heap and cached lists",
+                moved == 75 && heap.size() == 50 && other_cached.size() == 25 && cached.size() == 25);
+    heap.stable_partition([](int) { return false; }, cached);
+    cached.compact();
+    runner.test("ThreadCache - compact moves cached nodes into blocks",
+                cached.size() == 75 && cached.fragmentation() == 0.0);
+}
+
+// Test bounded-pause teardown
+void test_clear_step(TestRunner& runner) {
+    DoublyLinkedList dll;
+    for (int i = 0; i < 5000; ++i) dll.addBack(i);
+    int calls = 1;
+    while (!dll.clearStep(512)) {
+        ++calls;
+        if (dll.front() != (calls - 1) * 512) break;
+    }
+    runner.test("clearStep - frees from the front in bounded steps", dll.empty() && calls == 10);
+
+    for (int i = 0; i < 100; ++i) dll.addBack(i);
+    DoublyLinkedList copy = dll;
+    runner.test("clearStep - shared list lets go at once", dll.clearStep(1) && dll.empty() && copy.size() == 100);
+
+    copy.begin();
+    while (!copy.clearStep(7)) {}
+    copy.rollback();
+    runner.test("clearStep - inside a transaction rolls back", copy.size() == 100 && copy.back() == 99);
+
+    DoublyLinkedList snapshot = copy;
+    copy.begin();
+    bool done = copy.clearStep(30);
+    copy.rollback();
+    runner.test("clearStep - shared list in a transaction steps and rolls back",
+                !done && copy.size() == 100 && snapshot.size() == 100 && snapshot.front() == 0);
+}
+
+struct Entry : ListHook<> {
+    int id = 0;
+    bool operator==(const Entry& other) const { return id == other.id; }
+};
+
+struct Ready {};
+struct Timer : ListHook<>, ListHook<Ready> {
+    int id = 0;
+};
+
+std::vector<int> ids(const IntrusiveList<Entry>& list) {
+    std::vector<int> out;
+    list.forEach([&out](Entry& entry) { out.push_back(entry.id); });
+    return out;
+}
+
+void test_intrusive_list(TestRunner& runner) {
+    Entry entries[8];
+    for (int i = 0; i < 8; ++i) entries[i].id = i;
+    IntrusiveList<Entry> list;
+
+    long long before = allocations;
+    for (int i = 2; i < 6; ++i) list.addBack(entries[i]);
+    list.addFront(entries[1]);
+    list.insertBefore(entries[1], entries[0]);
+    list.insertAfter(entries[5], entries[6]);
+    entries[3].unlink();
+    IntrusiveList<Entry>::remove(entries[5]);
+    list.removeFront();
+    list.removeBack();
+    long long made = allocations - before;
+    runner.test("Intrusive - links caller objects", ids(list) == std::vector<int>{1, 2, 4} && list.size() == 3);
+    runner.test("Intrusive - add/remove never allocate", made == 0);
+    runner.test("Intrusive - unlink from anywhere", !entries[3].linked() && !entries[0].linked() && entries[4].linked());
+
+    list.addBack(entries[1]); // already on it: moves to the back
+    runner.test("Intrusive - adding a linked object moves it", ids(list) == std::vector<int>{2, 4, 1});
+
+    {
+        Entry temporary;
+        temporary.id = 9;
+        list.addFront(temporary);
+    }
+    runner.test("Intrusive - destroyed object leaves its list", ids(list) == std::vector<int>{2, 4, 1});
+
+    {
+        IntrusiveList<Entry> other;
+        other.addBack(entries[7]);
+        other.addBack(entries[4]); // taken off `list`
+        runner.test("Intrusive - objects move between lists", ids(list) == std::vector<int>{2, 1} && other.size() == 2);
+    }
+    runner.test("Intrusive - destroyed list unlinks its objects", !entries[7].linked() && !entries[4].linked());
+
+    list.clear();
+    int pattern[] = {1, 2, 3, 2, 1};
+    for (int i = 0; i < 5; ++i) {
+        entries[i].id = pattern[i];
+        list.addBack(entries[i]);
+    }
+    bool odd = list.isPalindrome();
+    entries[4].unlink();
+    entries[0].unlink();
+    entries[3].id = 4;
+    bool broken = list.isPalindrome();
+    bool byParity = list.isPalindrome([](const Entry& a, const Entry& b) { return a.id % 2 == b.id % 2; });
+    runner.test("Intrusive - isPalindrome", odd && !broken && byParity);
+
+    int removed = list.remove_if([](Entry& entry) { return entry.id == 2; });
+    runner.test("Intrusive - remove_if", removed == 1 && ids(list) == std::vector<int>{3, 4});
+
+    // One object on two lists at once, through tagged hooks
+    Timer timers[4];
+    IntrusiveList<Timer> all;
+    IntrusiveList<Timer, Ready> ready;
+    for (int i = 0; i < 4; ++i) {
+        timers[i].id = i;
+        all.addBack(timers[i]);
+        ready.addFront(timers[i]);
+    }
+    IntrusiveList<Timer, Ready>::remove(timers[2]);
+    runner.test("Intrusive - tagged hooks are independent",
+                all.size() == 4 && ready.size() == 3 && ready.front().id == 3 && ready.back().id == 0);
+}
+
+// Checks a batch of random ranges (some out of bounds or empty)
+// against sums, minima, maxima and counts taken straight off ref.
+bool ranges_agree(const DoublyLinkedList& dll, const std::deque<int>& ref, std::mt19937& rng) {
+    int n = int(ref.size());
+    std::uniform_int_distribution<int> pos(-2, n + 2);
+    for (int q = 0; q < 20; ++q) {
+        int i = pos(rng);
+        int j = pos(rng);
+        int value = ref.empty() ? 0 : ref[rng() % n];
+        long long sum = 0;
+        int least = INT_MAX, most = INT_MIN, count = 0;
+        for (int k = std::max(i, 0); k < std::min(j, n); ++k) {
+            sum += ref[k];
+            least = std::min(least, ref[k]);
+            most = std::max(most, ref[k]);
+            if (ref[k] == value) count++;
+        }
+        if (dll.rangeSum(i, j) != sum || dll.rangeMin(i, j) != least ||
+            dll.rangeMax(i, j) != most || dll.rangeCount(i, j, value) != count) return false;
+    }
+    return true;
+}
+
+void test_range_index(TestRunner& runner) {
+    std::mt19937 rng(49);
+    DoublyLinkedList dll;
+    std::deque<int> ref;
+    for (int i = 0; i < 1000; ++i) {
+        dll.addBack(i % 37 - 10);
+        ref.push_back(i % 37 - 10);
+    }
+    runner.test("Range - linear scans without an index", !dll.indexed() && ranges_agree(dll, ref, rng));
+    dll.buildIndex();
+    runner.test("Range - indexed queries", dll.indexed() && ranges_agree(dll, ref, rng) &&
+                dll.rangeSum(0, 1000) == std::accumulate(ref.begin(), ref.end(), 0LL));
+    runner.test("Range - empty and clamped ranges", dll.rangeSum(5, 5) == 0 && dll.rangeMin(7, 3) == INT_MAX &&
+                dll.rangeMax(2000, 3000) == INT_MIN && dll.rangeCount(-5, 2000, 26) == 27);
+
+    // Both ends churn: the ring grows, wraps and shrinks under the index
+    bool agree = true;
+    std::uniform_int_distribution<int> values(-1000, 1000);
+    for (int step = 0; step < 20000 && agree; ++step) {
+        int x = values(rng);
+        switch (rng() % 5) {
+            case 0: dll.addFront(x); ref.push_front(x); break;
+            case 1: case 2: dll.addBack(x); ref.push_back(x); break;
+            case 3: if (!ref.empty()) { dll.removeFront(); ref.pop_front(); } break;
+            case 4: if (!ref.empty()) { dll.removeBack(); ref.pop_back(); } break;
+        }
+        if (step % 200 == 0) agree = ranges_agree(dll, ref, rng);
+    }
+    runner.test("Range - kept up to date at both ends", agree && ranges_agree(dll, ref, rng));
+
+    dll.remove_if([](int x) { return x % 3 == 0; });
+    std::erase_if(ref, [](int x) { return x % 3 == 0; });
+    runner.test("Range - stale after remove_if, scans meanwhile", !dll.indexed() && ranges_agree(dll, ref, rng));
+
+    // A stale index is left alone by queries, so readers can share the list
+    std::vector<std::thread> readers;
+    bool agreed[2] = {false, false};
+    for (int r = 0; r < 2; ++r) {
+        readers.emplace_back([&, r] {
+            std::mt19937 own(r);
+            agreed[r] = ranges_agree(dll, ref, own);
+        });
+    }
+    for (std::thread& t : readers) t.join();
+    runner.test("Range - concurrent readers of a stale index", agreed[0] && agreed[1] && !dll.indexed());
+    dll.buildIndex();
+    runner.test("Range - rebuilt by buildIndex after remove_if", dll.indexed() && ranges_agree(dll, ref, rng));
+
+    DoublyLinkedList rest;
+    rest.buildIndex();
+    dll.stable_partition([](int x) { return x > 0; }, rest);
+    std::deque<int> kept, moved;
+    for (int x : ref) (x > 0 ? kept : moved).push_back(x);
+    runner.test("Range - stale after partition, both lists",
+                !dll.indexed() && !rest.indexed() && ranges_agree(dll, kept, rng) && ranges_agree(rest, moved, rng));
+    dll.buildIndex();
+    rest.buildIndex();
+    runner.test("Range - rebuilt after partition, both lists",
+                dll.indexed() && rest.indexed() && ranges_agree(dll, kept, rng) && ranges_agree(rest, moved, rng));
+
+    dll.begin();
+    for (int i = 0; i < 100; ++i) dll.addFront(i);
+    dll.removeBack();
+    dll.rollback();
+    runner.test("Range - stale after rollback", !dll.indexed() && ranges_agree(dll, kept, rng));
+    dll.buildIndex();
+    runner.test("Range - rebuilt after rollback", dll.indexed() && ranges_agree(dll, kept, rng));
+
+    DoublyLinkedList copy = dll;
+    copy.addBack(5);
+    dll.addBack(7);
+    kept.push_back(7);
+    runner.test("Range - copies share nodes, not the index",
+                !copy.indexed() && ranges_agree(dll, kept, rng) && copy.rangeSum(0, 1 << 30) == dll.rangeSum(0, 1 << 30) - 2);
+
+    dll.thaw(dll.freeze());
+    runner.test("Range - stale after freeze and thaw", !dll.indexed() && ranges_agree(dll, kept, rng));
+    dll.buildIndex();
+    runner.test("Range - rebuilt after freeze and thaw", dll.indexed() && ranges_agree(dll, kept, rng));
+    dll = rest;
+    runner.test("Range - stale after assignment", !dll.indexed() && ranges_agree(dll, moved, rng));
+    dll.buildIndex();
+    runner.test("Range - rebuilt after assignment", dll.indexed() && ranges_agree(dll, moved, rng));
+    dll.dropIndex();
+    runner.test("Range - dropped index falls back to scans", !dll.indexed() && ranges_agree(dll, moved, rng));
+}
+
 int main() {
     TestRunner runner;
     
@@ -285,10 +1278,24 @@ int main() {
     test_print_functionality(runner);
     test_memory_safety(runner);
     test_large_operations(runner);
+    test_copy_on_write(runner);
+    test_remove_if_partition(runner);
+    test_storage_modes(runner);
+    test_compact(runner);
+    test_ring_deque(runner);
+    test_channel(runner);
+    test_work_stealing(runner);
+    test_inline_nodes(runner);
+    test_transactions(runner);
+    test_freeze(runner);
+    test_thread_cache(runner);
+    test_clear_step(runner);
+    test_intrusive_list(runner);
+    test_range_index(runner);
     
     runner.summary();
     
-    return 0;
+    return runner.failures() > 0 ? 1 : 0;
 }
 
 // Expected results: All tests should pass with your fixes
@@ -0,0 +1,146 @@
+#include "worksteal.h"
+using namespace std;
+
+
+ChaseLevDeque::ChaseLevDeque(long long capacity) {
+    long long size = 1;
+    while (size < capacity) size <<= 1;
+    rings.emplace_back(new Ring(size));
+    ring.store(rings.back().get(), memory_order_relaxed);
+}
+
+bool ChaseLevDeque::empty() const {
+    return bottom.load(memory_order_acquire) <= top.load(memory_order_acquire);
+}
+
+// Top and bottom go through seq_cst operations rather than the paper's
+// standalone fences; same ordering, and ThreadSanitizer understands it.
+void ChaseLevDeque::addBack(Job* job) {
+    long long b = bottom.load(memory_order_relaxed);
+    long long t = top.load(memory_order_acquire);
+    Ring* r = ring.load(memory_order_relaxed);
+    if (b - t >= r->size) {
+        Ring* bigger = new Ring(r->size * 2);
+        for (long long i = t; i < b; i++) bigger->put(i, r->get(i));
+        rings.emplace_back(bigger);
+        ring.store(bigger, memory_order_release);
+        r = bigger;
+    }
+    r->put(b, job);
+    bottom.store(b + 1, memory_order_seq_cst);
+}
+
+Job* ChaseLevDeque::removeBack() {
+    long long b = bottom.load(memory_order_relaxed) - 1;
+    Ring* r = ring.load(memory_order_relaxed);
+    bottom.store(b, memory_order_seq_cst);
+    long long t = top.load(memory_order_seq_cst);
+    if (t > b) {
+        bottom.store(b + 1, memory_order_relaxed); // was empty
+        return nullptr;
+    }
+    Job* job = r->get(b);
+    if (t == b) {
+        // Last job: race the thieves for it
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+            job = nullptr;
+        }
+        bottom.store(b + 1, memory_order_relaxed);
+    }
+    return job;
+}
+
+Job* ChaseLevDeque::removeFront() {
+    long long t = top.load(memory_order_seq_cst);
+    long long b = bottom.load(memory_order_seq_cst);
+    if (t >= b) return nullptr;
+    Ring* r = ring.load(memory_order_acquire);
+    Job* job = r->get(t);
+    if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) {
+        return nullptr; // lost the race
+    }
+    return job;
+}
+
+
+namespace {
+thread_local WorkStealingPool* currentPool = nullptr;
+thread_local int slotHere = 0;
+}
+
+WorkStealingPool::WorkStealingPool(int threads): threads(threads < 1 ? 1 : threads) {
+    for (int i = 0; i < this->threads; i++) {
+        deques.emplace_back(new ChaseLevDeque);
+    }
+    for (int i = 1; i < this->threads; i++) {
+        workers.emplace_back([this, i] { work(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& t : workers) t.join();
+}
+
+int WorkStealingPool::currentSlot() const {
+    return currentPool == this ? slotHere : 0;
+}
+
+void WorkStealingPool::push(Job* job) {
+    deques[currentSlot()]->addBack(job);
+}
+
+// Own deque first (newest job, still warm in cache), then the oldest
+// job of the others, starting from a different victim each time.
+Job* WorkStealingPool::find(int slot) {
+    if (Job* job = deques[slot]->removeBack()) return job;
+    static thread_local unsigned seed = 12345u + slot;
+    seed = seed * 1103515245u + 12345u;
+    int start = (seed >> 16) % threads;
+    for (int i = 0; i < threads; i++) {
+        int victim = (start + i) % threads;
+        if (victim == slot) continue;
+        if (Job* job = deques[victim]->removeFront()) return job;
+    }
+    return nullptr;
+}
+
+void WorkStealingPool::work(int slot) {
+    currentPool = this;
+    slotHere = slot;
+    while (true) {
+        if (active.load(memory_order_acquire) == 0) {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [this] { return stopping || active.load(memory_order_acquire) > 0; });
+            if (stopping) return;
+        }
+        if (Job* job = find(slot)) job->run(slot);
+        else this_thread::yield();
+    }
+}
+
+void WorkStealingPool::runUntil(Job* job, atomic<int>& pending) {
+    bool outer = currentPool != this;
+    int slot = currentSlot();
+    if (outer) {
+        currentPool = this;
+        slotHere = 0;
+    }
+    if (active.fetch_add(1, memory_order_acq_rel) == 0) {
+        lock_guard<mutex> guard(lock);
+        wake.notify_all();
+    }
+
+    job->run(slot);
+    while (pending.load(memory_order_acquire) > 0) {
+        if (Job* next = find(slot)) next->run(slot);
+        else this_thread::yield();
+    }
+
+    active.fetch_sub(1, memory_order_acq_rel);
+    if (outer) currentPool = nullptr;
+}
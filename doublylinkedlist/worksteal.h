@@ -0,0 +1,146 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// One unit of work for the WorkStealingPool. `slot` is the worker
+// running it, for per-worker state.
+struct Job {
+    virtual ~Job() = default;
+    virtual void run(int slot) = 0;
+};
+
+// Chase-Lev work-stealing deque of jobs. Same ends as DoublyLinkedList:
+// the owning worker uses addBack/removeBack (LIFO, lock-free, no
+// contention unless one job is left); any other thread may take the
+// oldest job with removeFront. removeFront can fail when it races with
+// another thief or the owner, returning nullptr like an empty deque.
+class ChaseLevDeque {
+private:
+    struct Ring {
+        long long size;
+        std::unique_ptr<std::atomic<Job*>[]> slots;
+        explicit Ring(long long n): size(n), slots(new std::atomic<Job*>[n]) {}
+        Job* get(long long i) const { return slots[i & (size - 1)].load(std::memory_order_relaxed); }
+        void put(long long i, Job* j) { slots[i & (size - 1)].store(j, std::memory_order_relaxed); }
+    };
+
+    alignas(64) std::atomic<long long> top {0};
+    alignas(64) std::atomic<long long> bottom {0};
+    std::atomic<Ring*> ring;
+    // Outgrown rings stay alive until the deque goes: a thief may still
+    // be reading one.
+    std::vector<std::unique_ptr<Ring>> rings;
+
+public:
+    explicit ChaseLevDeque(long long capacity = 256);
+    ChaseLevDeque(const ChaseLevDeque&) = delete;
+    ChaseLevDeque& operator=(const ChaseLevDeque&) = delete;
+
+    void addBack(Job* job);  // owner only
+    Job* removeBack();       // owner only
+    Job* removeFront();      // any thread
+    bool empty() const;
+};
+
+// Fixed set of workers, each with its own ChaseLevDeque; idle workers
+// steal from the others. Slot 0 is the thread that calls parallel_for
+// or parallel_reduce, which works on the call until it finishes, so
+// `threads` counts it. Calls may nest inside jobs; from outside, call
+// from one thread at a time.
+class WorkStealingPool {
+private:
+    int threads;
+    std::vector<std::unique_ptr<ChaseLevDeque>> deques;
+    std::vector<std::thread> workers;
+
+    std::mutex lock;
+    std::condition_variable wake;
+    std::atomic<int> active {0}; // parallel calls in flight
+    bool stopping {false};
+
+    int currentSlot() const;
+    Job* find(int slot);
+    void work(int slot);
+
+    template <typename Body> struct RangeJob;
+
+public:
+    explicit WorkStealingPool(int threads);
+    ~WorkStealingPool();
+
+    int size() const { return threads; }
+
+    // Runs job on this thread, plus whatever it spawns and whatever can
+    // be stolen, until `pending` drops to zero.
+    void runUntil(Job* job, std::atomic<int>& pending);
+    // From inside a job: queue another one on this worker's deque.
+    void push(Job* job);
+
+    // Calls body(lo, hi) over disjoint subranges covering [begin, end),
+    // none longer than grain. Ranges split in half on demand, so idle
+    // workers steal big pieces.
+    template <typename Body>
+    void parallel_for(int begin, int end, int grain, const Body& body);
+
+    // map(lo, hi) reduces one subrange; combine(a, b) merges results and
+    // must be associative and commutative (workers combine in any order).
+    template <typename T, typename Map, typename Combine>
+    T parallel_reduce(int begin, int end, int grain, T identity, const Map& map, const Combine& combine);
+};
+
+template <typename Body>
+struct WorkStealingPool::RangeJob : Job {
+    WorkStealingPool& pool;
+    const Body& body;
+    std::atomic<int>& pending;
+    int lo, hi, grain;
+
+    RangeJob(WorkStealingPool& p, const Body& b, std::atomic<int>& n, int l, int h, int g)
+        : pool(p), body(b), pending(n), lo(l), hi(h), grain(g) {}
+
+    void run(int slot) override {
+        // Keep the front half, offer the back half to thieves
+        while (hi - lo > grain) {
+            int mid = lo + (hi - lo) / 2;
+            pending.fetch_add(1, std::memory_order_relaxed);
+            pool.push(new RangeJob(pool, body, pending, mid, hi, grain));
+            hi = mid;
+        }
+        body(lo, hi, slot);
+        std::atomic<int>& left = pending;
+        delete this;
+        left.fetch_sub(1, std::memory_order_release);
+    }
+};
+
+template <typename Body>
+void WorkStealingPool::parallel_for(int begin, int end, int grain, const Body& body) {
+    if (begin >= end) return;
+    if (grain < 1) grain = 1;
+    auto call = [&body](int lo, int hi, int) { body(lo, hi); };
+    std::atomic<int> pending {1};
+    runUntil(new RangeJob<decltype(call)>(*this, call, pending, begin, end, grain), pending);
+}
+
+template <typename T, typename Map, typename Combine>
+T WorkStealingPool::parallel_reduce(int begin, int end, int grain, T identity,
+                                    const Map& map, const Combine& combine) {
+    if (begin >= end) return identity;
+    if (grain < 1) grain = 1;
+    // One accumulator per worker, on its own cache line
+    struct alignas(64) Partial { T value; };
+    std::vector<Partial> partial(threads, Partial {identity});
+    auto call = [&](int lo, int hi, int slot) {
+        T part = map(lo, hi); // may run other jobs on this slot if it nests
+        partial[slot].value = combine(partial[slot].value, part);
+    };
+    std::atomic<int> pending {1};
+    runUntil(new RangeJob<decltype(call)>(*this, call, pending, begin, end, grain), pending);
+    T result = identity;
+    for (Partial& p : partial) result = combine(result, p.value);
+    return result;
+}
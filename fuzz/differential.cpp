@@ -0,0 +1,479 @@
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
+#include "differential.h"
+using namespace std;
+
+namespace {
+
+const NodeStorage modes[ListDifferential::storages] = {
+    NodeStorage::Heap, NodeStorage::Deferred, NodeStorage::Background,
+    NodeStorage::Pool, NodeStorage::ThreadCache};
+const char* const modeNames[ListDifferential::storages] = {
+    "heap", "deferred", "background", "pool", "thread cache"};
+
+// The first byte of each pair indexes this table; the weights favour
+// adds, so lists get long enough to spill out of the inline nodes.
+const FuzzOp opTable[32] = {
+    FuzzOp::AddFront, FuzzOp::AddFront, FuzzOp::AddFront,
+    FuzzOp::AddFront, FuzzOp::AddFront, FuzzOp::Fill,
+    FuzzOp::AddBack, FuzzOp::AddBack, FuzzOp::AddBack,
+    FuzzOp::AddBack, FuzzOp::AddBack, FuzzOp::AddBack,
+    FuzzOp::RemoveFront, FuzzOp::RemoveFront, FuzzOp::RemoveFront,
+    FuzzOp::RemoveBack, FuzzOp::RemoveBack, FuzzOp::RemoveBack,
+    FuzzOp::RemoveAll, FuzzOp::RemoveAll, FuzzOp::RemoveAll,
+    FuzzOp::Reverse, FuzzOp::Mirror, FuzzOp::Snapshot,
+    FuzzOp::Begin, FuzzOp::Begin, FuzzOp::Commit, FuzzOp::Rollback,
+    FuzzOp::CompactStep, FuzzOp::RemoveAllStep, FuzzOp::ClearStep, FuzzOp::FreezeThaw};
+
+const char* const opNames[] = {
+    "addFront", "addBack", "removeFront", "removeBack", "removeAll", "reverse",
+    "mirror", "snapshot", "begin", "commit", "rollback", "compactStep",
+    "removeAllStep", "clearStep", "freezeThaw", "fill"};
+
+// The values a list's print() writes, skipping whatever it says when
+// empty. The stream is reused: setting one up costs more than the print.
+template <typename List>
+vector<int> printed(const List& list) {
+    static ostringstream out;
+    out.str("");
+    streambuf* old = cout.rdbuf(out.rdbuf());
+    const_cast<List&>(list).print(); // IntLinkedList::print() isn't const
+    cout.rdbuf(old);
+    vector<int> values;
+    string text = out.str();
+    for (const char* p = text.c_str(); *p;) {
+        char* end;
+        long v = strtol(p, &end, 10);
+        if (end == p) {
+            p++;
+            continue;
+        }
+        values.push_back(int(v));
+        p = end;
+    }
+    return values;
+}
+
+string show(const vector<int>& values) {
+    string s = "[";
+    for (size_t i = 0; i < values.size(); i++) s += (i ? " " : "") + to_string(values[i]);
+    return s + "]";
+}
+
+// Fill's values: 256 distinct ones in a shuffled cycle, so each
+// RangeIndex block gets its own min and max (RemoveAll's 16 values
+// would put -4 and 11 in nearly every block).
+int spread(int arg, int k) {
+    return ((k * 97 + arg * 13) & 255) - 4;
+}
+
+bool palindrome(const vector<int>& v) {
+    return equal(v.begin(), v.begin() + v.size() / 2, v.rbegin());
+}
+
+}
+
+
+ListDifferential::ListDifferential(int maxSize): maxSize(maxSize), sitems(maxSize), ditems(maxSize) {
+    for (int m = 0; m < storages; m++) {
+        singly[m] = make_unique<IntLinkedList>(modes[m]);
+        doubly[m] = make_unique<DoublyLinkedList>(modes[m]);
+        if (m > 0) doubly[m]->buildIndex(); // heap keeps the linear scans
+        copies[m] = make_unique<DoublyLinkedList>(modes[m]);
+    }
+}
+
+const string& ListDifferential::failure() const {
+    return failed;
+}
+
+long long ListDifferential::operations() const {
+    return steps;
+}
+
+int ListDifferential::largest() const {
+    return largestSize;
+}
+
+bool ListDifferential::fail(const string& backend, const string& what) {
+    if (failed.empty()) failed = backend + ": " + what;
+    return false;
+}
+
+bool ListDifferential::same(const string& backend, const char* what, long long got, long long want) {
+    if (got == want) return true;
+    return fail(backend, string(what) + " " + to_string(got) + ", expected " + to_string(want));
+}
+
+bool ListDifferential::sameContents(const string& backend, const vector<int>& got, const vector<int>& want) {
+    if (got == want) return true;
+    return fail(backend, "contents " + show(got) + ", expected " + show(want));
+}
+
+void ListDifferential::addSingly(int x, bool front) {
+    if (singlySize >= maxSize) return;
+    if (front) {
+        singlyRef.push_front(x);
+    } else {
+        auto last = singlyRef.before_begin();
+        for (auto it = singlyRef.begin(); it != singlyRef.end(); ++it) last = it;
+        singlyRef.insert_after(last, x);
+    }
+    singlySize++;
+    for (auto& list : singly) front ? list->addFront(x) : list->addBack(x);
+    front ? runs.addFront(x) : runs.addBack(x);
+    FuzzSItem& item = sitems.take(x);
+    front ? islist.addFront(item) : islist.addBack(item);
+}
+
+void ListDifferential::addDoubly(int x, bool front) {
+    if (int(doublyRef.size()) >= maxSize) return;
+    front ? doublyRef.push_front(x) : doublyRef.push_back(x);
+    for (auto& list : doubly) front ? list->addFront(x) : list->addBack(x);
+    front ? ring.addFront(x) : ring.addBack(x);
+    FuzzDItem& item = ditems.take(x);
+    front ? ilist.addFront(item) : ilist.addBack(item);
+}
+
+// Takes up to n values off the front of the references and the
+// backends that have no clearStep().
+void ListDifferential::popSingly(int n) {
+    for (; n > 0 && singlySize > 0; n--) {
+        singlyRef.pop_front();
+        singlySize--;
+        runs.removeFront();
+        FuzzSItem& item = islist.front();
+        islist.removeFront();
+        sitems.give(item);
+    }
+}
+
+void ListDifferential::popDoubly(int n) {
+    for (; n > 0 && !doublyRef.empty(); n--) {
+        doublyRef.pop_front();
+        ring.removeFront();
+        FuzzDItem& item = ilist.front();
+        ilist.removeFront();
+        ditems.give(item);
+    }
+}
+
+// After a rollback: the backends without transactions start over from
+// the restored reference.
+void ListDifferential::rebuildDoubly() {
+    ring = RingDeque();
+    while (!ilist.empty()) {
+        FuzzDItem& item = ilist.front();
+        ilist.removeFront();
+        ditems.give(item);
+    }
+    for (int x : doublyRef) {
+        ring.addBack(x);
+        ilist.addBack(ditems.take(x));
+    }
+}
+
+void ListDifferential::applySingly(FuzzOp op, int arg) {
+    int x = (arg & 15) - 4; // few distinct values, so removeAll finds some
+    int budget = arg % 8 + 1;
+    switch (op) {
+    case FuzzOp::AddFront:
+    case FuzzOp::AddBack:
+        addSingly(x, op == FuzzOp::AddFront);
+        break;
+    case FuzzOp::Fill:
+        for (int k = 0; k < arg; k++) addSingly(spread(arg, k), k & 1);
+        break;
+    case FuzzOp::RemoveFront:
+        for (auto& list : singly) list->removeFront(); // on empty lists too
+        popSingly(1);
+        break;
+    case FuzzOp::RemoveBack: {
+        for (auto& list : singly) list->removeBack();
+        runs.removeBack();
+        if (singlySize == 0) break;
+        auto before = singlyRef.before_begin();
+        for (auto it = singlyRef.begin(); next(it) != singlyRef.end(); ++it) before = it;
+        singlyRef.erase_after(before);
+        singlySize--;
+        FuzzSItem& item = islist.back();
+        islist.removeBack();
+        sitems.give(item);
+        break;
+    }
+    case FuzzOp::RemoveAll:
+    case FuzzOp::RemoveAllStep: {
+        int expected = int(count(singlyRef.begin(), singlyRef.end(), x));
+        singlyRef.remove(x);
+        singlySize -= expected;
+        for (int m = 0; m < storages; m++) {
+            int removed = 0;
+            if (op == FuzzOp::RemoveAll) {
+                removed = singly[m]->removeAll(x);
+            } else {
+                while (!singly[m]->removeAllStep(x, budget, removed)) {}
+            }
+            same(string("IntLinkedList (") + modeNames[m] + ")", "removed", removed, expected);
+        }
+        same("RunLengthIntList", "removed", runs.removeAll(x), expected);
+        int unlinked = islist.remove_if([&](FuzzSItem& item) {
+            if (item.value != x) return false;
+            sitems.give(item);
+            return true;
+        });
+        same("IntrusiveSList", "removed", unlinked, expected);
+        break;
+    }
+    case FuzzOp::Reverse:
+        singlyRef.reverse();
+        for (auto& list : singly) list->reverse();
+        runs.reverse();
+        islist.reverse();
+        break;
+    case FuzzOp::Mirror: {
+        vector<int> values(singlyRef.begin(), singlyRef.end());
+        for (auto it = values.rbegin(); it != values.rend(); ++it) addSingly(*it, false);
+        break;
+    }
+    case FuzzOp::Snapshot:
+        persistent = PersistentIntList(*singly[0]);
+        persistentRef.assign(singlyRef.begin(), singlyRef.end());
+        break;
+    case FuzzOp::CompactStep:
+        for (auto& list : singly) list->compactStep(budget);
+        break;
+    case FuzzOp::ClearStep:
+        for (auto& list : singly) list->clearStep(budget);
+        popSingly(budget);
+        break;
+    case FuzzOp::FreezeThaw:
+        for (int m = 0; m < storages; m++) {
+            FrozenIntList frozen = singly[m]->freeze();
+            same(string("FrozenIntList (") + modeNames[m] + ")", "size", frozen.size(), singlySize);
+            singly[m]->thaw(frozen);
+        }
+        break;
+    case FuzzOp::Begin:
+    case FuzzOp::Commit:
+    case FuzzOp::Rollback:
+        break;
+    }
+}
+
+void ListDifferential::applyDoubly(FuzzOp op, int arg) {
+    int x = (arg & 15) - 4;
+    int budget = arg % 8 + 1;
+    switch (op) {
+    case FuzzOp::AddFront:
+    case FuzzOp::AddBack:
+        addDoubly(x, op == FuzzOp::AddFront);
+        break;
+    case FuzzOp::Fill:
+        for (int k = 0; k < arg; k++) addDoubly(spread(arg, k), k & 1);
+        break;
+    case FuzzOp::RemoveFront:
+        for (auto& list : doubly) list->removeFront();
+        popDoubly(1);
+        break;
+    case FuzzOp::RemoveBack: {
+        for (auto& list : doubly) list->removeBack();
+        ring.removeBack();
+        if (doublyRef.empty()) break;
+        doublyRef.pop_back();
+        FuzzDItem& item = ilist.back();
+        ilist.removeBack();
+        ditems.give(item);
+        break;
+    }
+    case FuzzOp::RemoveAll:
+    case FuzzOp::RemoveAllStep: {
+        int expected = int(count(doublyRef.begin(), doublyRef.end(), x));
+        doublyRef.remove(x);
+        auto matches = [x](int v) { return v == x; };
+        for (int m = 0; m < storages; m++) {
+            same(string("DoublyLinkedList (") + modeNames[m] + ")", "removed", doubly[m]->remove_if(matches), expected);
+        }
+        same("RingDeque", "removed", ring.remove_if(matches), expected);
+        int unlinked = ilist.remove_if([&](FuzzDItem& item) {
+            if (item.value != x) return false;
+            ditems.give(item);
+            return true;
+        });
+        same("IntrusiveList", "removed", unlinked, expected);
+        break;
+    }
+    case FuzzOp::Reverse:
+        break;
+    case FuzzOp::Mirror: {
+        vector<int> values(doublyRef.begin(), doublyRef.end());
+        for (auto it = values.rbegin(); it != values.rend(); ++it) addDoubly(*it, false);
+        break;
+    }
+    case FuzzOp::Snapshot:
+        for (int m = 0; m < storages; m++) *copies[m] = *doubly[m];
+        copiesRef.assign(doublyRef.begin(), doublyRef.end());
+        haveCopies = true;
+        break;
+    case FuzzOp::Begin:
+        for (auto& list : doubly) list->begin();
+        savepoints.push_back(doublyRef);
+        break;
+    case FuzzOp::Commit:
+        if (savepoints.empty()) break;
+        for (auto& list : doubly) list->commit();
+        savepoints.pop_back();
+        break;
+    case FuzzOp::Rollback:
+        if (savepoints.empty()) break;
+        for (auto& list : doubly) list->rollback();
+        doublyRef = savepoints.back();
+        savepoints.pop_back();
+        rebuildDoubly();
+        break;
+    case FuzzOp::CompactStep:
+        for (auto& list : doubly) list->compactStep(budget); // commits
+        savepoints.clear();
+        break;
+    case FuzzOp::ClearStep: {
+        // A list still sharing its nodes with its copy lets go of all of
+        // them, unless a transaction is open
+        bool shared = savepoints.empty() && doubly[0]->sharesWith(*copies[0]);
+        for (int m = 0; m < storages; m++) {
+            string name = string("DoublyLinkedList (") + modeNames[m] + ")";
+            same(name, "sharing", savepoints.empty() && doubly[m]->sharesWith(*copies[m]), shared);
+            doubly[m]->clearStep(budget);
+        }
+        popDoubly(shared ? maxSize : budget);
+        break;
+    }
+    case FuzzOp::FreezeThaw:
+        for (int m = 0; m < storages; m++) {
+            FrozenIntList frozen = doubly[m]->freeze(); // commits
+            same(string("FrozenIntList (") + modeNames[m] + ")", "size", frozen.size(), int(doublyRef.size()));
+            doubly[m]->thaw(frozen);
+        }
+        savepoints.clear();
+        break;
+    }
+}
+
+bool ListDifferential::checkSingly() {
+    vector<int> want(singlyRef.begin(), singlyRef.end());
+    int sum = accumulate(want.begin(), want.end(), 0);
+    for (int m = 0; m < storages; m++) {
+        IntLinkedList& list = *singly[m];
+        string name = string("IntLinkedList (") + modeNames[m] + ")";
+        if (!same(name, "empty", list.empty(), want.empty()) ||
+            !same(name, "size", list.size(), singlySize) ||
+            !same(name, "sum", list.sum(), sum) ||
+            !sameContents(name, printed(list), want)) return false;
+    }
+    if (!same("RunLengthIntList", "size", runs.size(), singlySize) ||
+        !same("RunLengthIntList", "sum", runs.sum(), sum) ||
+        !sameContents("RunLengthIntList", printed(runs), want)) return false;
+    if (!want.empty() &&
+        (!same("RunLengthIntList", "front", runs.front(), want.front()) ||
+         !same("RunLengthIntList", "back", runs.back(), want.back()))) return false;
+
+    vector<int> linked;
+    islist.forEach([&linked](FuzzSItem& item) { linked.push_back(item.value); });
+    if (!same("IntrusiveSList", "size", islist.size(), singlySize) ||
+        !sameContents("IntrusiveSList", linked, want)) return false;
+    if (!want.empty() &&
+        (!same("IntrusiveSList", "front", islist.front().value, want.front()) ||
+         !same("IntrusiveSList", "back", islist.back().value, want.back()))) return false;
+
+    return same("PersistentIntList snapshot", "size", persistent.size(), int(persistentRef.size())) &&
+           same("PersistentIntList snapshot", "sum", persistent.sum(),
+                accumulate(persistentRef.begin(), persistentRef.end(), 0)) &&
+           sameContents("PersistentIntList snapshot", printed(persistent), persistentRef);
+}
+
+bool ListDifferential::checkDoubly() {
+    vector<int> want(doublyRef.begin(), doublyRef.end());
+    bool symmetric = palindrome(want);
+    int size = int(want.size());
+    auto checkQueue = [&](const auto& list, const string& name) {
+        if (!same(name, "empty", list.empty(), want.empty()) ||
+            !same(name, "size", list.size(), size) ||
+            !same(name, "isPalindrome", list.isPalindrome(), symmetric) ||
+            !sameContents(name, printed(list), want)) return false;
+        return want.empty() ||
+               (same(name, "front", list.front(), want.front()) && same(name, "back", list.back(), want.back()));
+    };
+    // Two ranges that move about with the step count: a long one, and
+    // a short one that covers only a few blocks, so a stale block
+    // summary can't hide behind its neighbours.
+    struct Expected {
+        int i, j, value;
+        long long sum;
+        int least, most, count;
+    };
+    auto expect = [&](int i, int j) {
+        Expected e {i, j, size ? want[(i + j) / 2 % size] : 0, 0, INT_MAX, INT_MIN, 0};
+        for (int k = max(i, 0); k < min(j, size); k++) {
+            e.sum += want[k];
+            e.least = min(e.least, want[k]);
+            e.most = max(e.most, want[k]);
+            if (want[k] == e.value) e.count++;
+        }
+        return e;
+    };
+    int at = size ? int(steps * 37 % size) : 0;
+    Expected ranges[] = {expect(size ? int(steps % size) : 0, size - int(steps % 3)),
+                         expect(at, at + 64 + int(steps % 130))};
+    auto checkRanges = [&](const DoublyLinkedList& list, const string& name) {
+        for (const Expected& e : ranges) {
+            if (!same(name, "rangeSum", list.rangeSum(e.i, e.j), e.sum) ||
+                !same(name, "rangeMin", list.rangeMin(e.i, e.j), e.least) ||
+                !same(name, "rangeMax", list.rangeMax(e.i, e.j), e.most) ||
+                !same(name, "rangeCount", list.rangeCount(e.i, e.j, e.value), e.count)) return false;
+        }
+        return true;
+    };
+    for (int m = 0; m < storages; m++) {
+        string name = string("DoublyLinkedList (") + modeNames[m] + ")";
+        if (!checkQueue(*doubly[m], name) || !checkRanges(*doubly[m], name)) return false;
+        // A change in the middle left the index stale and the queries
+        // walking; rebuild it and check it as well
+        if (m > 0 && !doubly[m]->indexed()) {
+            doubly[m]->buildIndex();
+            if (!checkRanges(*doubly[m], name + ", rebuilt index")) return false;
+        }
+        if (haveCopies && !sameContents(name + " copy", printed(*copies[m]), copiesRef)) return false;
+    }
+    if (!checkQueue(ring, "RingDeque")) return false;
+
+    vector<int> linked;
+    ilist.forEach([&linked](FuzzDItem& item) { linked.push_back(item.value); });
+    auto sameValue = [](const FuzzDItem& a, const FuzzDItem& b) { return a.value == b.value; };
+    if (!same("IntrusiveList", "size", ilist.size(), size) ||
+        !same("IntrusiveList", "isPalindrome", ilist.isPalindrome(sameValue), symmetric) ||
+        !sameContents("IntrusiveList", linked, want)) return false;
+    return want.empty() ||
+           (same("IntrusiveList", "front", ilist.front().value, want.front()) &&
+            same("IntrusiveList", "back", ilist.back().value, want.back()));
+}
+
+bool ListDifferential::step(FuzzOp op, int arg) {
+    if (!failed.empty()) return false;
+    steps++;
+    applySingly(op, arg);
+    applyDoubly(op, arg);
+    largestSize = max({largestSize, singlySize, int(doublyRef.size())});
+    if (failed.empty() && checkSingly() && checkDoubly()) return true;
+    failed = "step " + to_string(steps) + ", " + opNames[int(op)] + "(" + to_string(arg) + "): " + failed;
+    return false;
+}
+
+bool ListDifferential::run(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        if (!step(opTable[data[i] % 32], data[i + 1])) return false;
+    }
+    return true;
+}
@@ -0,0 +1,144 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <forward_list>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ldlist.h"
+#include "rlelist.h"
+#include "plist.h"
+#include "islist.h"
+#include "dldlist.h"
+#include "ringdeque.h"
+#include "ilist.h"
+
+// Differential testing: every list backend runs the same operations in
+// lockstep with a std::forward_list (singly backends) or std::list
+// (doubly backends) reference, and after each one size, sum, front,
+// back, isPalindrome and the full contents (through print()) must agree,
+// and so must DoublyLinkedList's range queries, indexed or not.
+//
+// Input is raw bytes, two per operation: the first picks the operation,
+// the second its value (or budget). Any byte string is valid, so the
+// same input drives the libFuzzer target (list_fuzz) and the
+// random-seed stress driver (list_stress), which also replays saved
+// fuzzer inputs.
+
+enum class FuzzOp : uint8_t {
+    AddFront,
+    AddBack,
+    RemoveFront,
+    RemoveBack,
+    RemoveAll,
+    Reverse,       // singly only
+    Mirror,        // appends the list reversed, making a palindrome
+    Snapshot,      // PersistentIntList / DoublyLinkedList copies, checked from then on
+    Begin,         // DoublyLinkedList transactions
+    Commit,
+    Rollback,
+    CompactStep,
+    RemoveAllStep, // singly: removeAllStep() until done; doubly: RemoveAll
+    ClearStep,     // one clearStep()
+    FreezeThaw,    // thaw(freeze())
+    Fill           // up to arg adds at alternating ends, so lists outgrow small sizes
+};
+
+// Objects linked by the intrusive backends.
+struct FuzzSItem : SListHook<> {
+    int value;
+};
+
+struct FuzzDItem : ListHook<> {
+    int value;
+};
+
+// Fixed set of caller-owned objects; never reallocates.
+template <typename T>
+class FuzzItemPool {
+private:
+    std::vector<T> items;
+    std::vector<T*> unused;
+
+public:
+    explicit FuzzItemPool(int n): items(n) {
+        for (T& x : items) unused.push_back(&x);
+    }
+
+    T& take(int value) {
+        T* x = unused.back();
+        unused.pop_back();
+        x->value = value;
+        return *x;
+    }
+
+    void give(T& x) {
+        unused.push_back(&x);
+    }
+};
+
+class ListDifferential {
+public:
+    static const int defaultMaxSize = 64; // keeps libFuzzer inputs fast
+    static const int storages = 5;        // one list per NodeStorage mode
+
+private:
+    const int maxSize;    // adds past this are skipped
+    int largestSize {0};  // of either reference so far
+    std::forward_list<int> singlyRef;
+    int singlySize {0};
+    std::list<int> doublyRef;
+    std::vector<std::list<int>> savepoints; // doublyRef at each open begin()
+    std::vector<int> persistentRef;
+    std::vector<int> copiesRef;
+    bool haveCopies {false};
+
+    // Declared before the intrusive lists, so they outlive them
+    FuzzItemPool<FuzzSItem> sitems;
+    FuzzItemPool<FuzzDItem> ditems;
+
+    std::unique_ptr<IntLinkedList> singly[storages];
+    RunLengthIntList runs;
+    IntrusiveSList<FuzzSItem> islist;
+    PersistentIntList persistent;
+
+    std::unique_ptr<DoublyLinkedList> doubly[storages];
+    std::unique_ptr<DoublyLinkedList> copies[storages];
+    RingDeque ring;
+    IntrusiveList<FuzzDItem> ilist;
+
+    std::string failed;
+    long long steps {0};
+
+    bool fail(const std::string& backend, const std::string& what);
+    bool same(const std::string& backend, const char* what, long long got, long long want);
+    bool sameContents(const std::string& backend, const std::vector<int>& got, const std::vector<int>& want);
+
+    void addSingly(int x, bool front);
+    void addDoubly(int x, bool front);
+    void popSingly(int n);
+    void popDoubly(int n);
+    void rebuildDoubly();
+    void applySingly(FuzzOp op, int arg);
+    void applyDoubly(FuzzOp op, int arg);
+    bool checkSingly();
+    bool checkDoubly();
+
+public:
+    // A maxSize of a few thousand takes lists through RangeIndex
+    // growth, many 64-slot blocks and ThreadCache depot trades.
+    explicit ListDifferential(int maxSize = defaultMaxSize);
+    ListDifferential(const ListDifferential&) = delete;
+    ListDifferential& operator=(const ListDifferential&) = delete;
+
+    // Applies one operation to every backend and checks them all.
+    bool step(FuzzOp op, int arg);
+    // Runs the operations encoded in data; false at the first mismatch.
+    bool run(const uint8_t* data, std::size_t size);
+
+    // What went wrong and at which step; empty while all agree.
+    const std::string& failure() const;
+    long long operations() const;
+    int largest() const;
+};
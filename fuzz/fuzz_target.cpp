@@ -0,0 +1,15 @@
+#include <cstdio>
+#include <cstdlib>
+#include "differential.h"
+
+// libFuzzer entry point (configure with LIST_FUZZER=ON, needs clang).
+// Every input starts from empty lists; a mismatch aborts, so libFuzzer
+// keeps the input, which list_stress can then replay.
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    ListDifferential diff;
+    if (!diff.run(data, size)) {
+        std::fprintf(stderr, "list_fuzz: %s\n", diff.failure().c_str());
+        std::abort();
+    }
+    return 0;
+}
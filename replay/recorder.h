@@ -0,0 +1,83 @@
+#pragma once
+#include "trace.h"
+#include "ldlist.h"
+#include "dldlist.h"
+#include "ringdeque.h"
+
+// Thin wrappers that log every call to a trace before forwarding it to
+// the wrapped list. Use them in place of the list to capture real traffic.
+// replayRecord() is the other direction: it applies one record to a list.
+
+class RecordingIntList {
+private:
+    IntLinkedList& list;
+    TraceWriter& out;
+
+public:
+    RecordingIntList(IntLinkedList& l, TraceWriter& w): list(l), out(w) {}
+
+    bool empty() const { return list.empty(); }
+    void addFront(int i) { out.record(Op::AddFront, i); list.addFront(i); }
+    void addBack(int i) { out.record(Op::AddBack, i); list.addBack(i); }
+    void removeFront() { out.record(Op::RemoveFront); list.removeFront(); }
+    void removeBack() { out.record(Op::RemoveBack); list.removeBack(); }
+    int removeAll(int x) { out.record(Op::RemoveAll, x); return list.removeAll(x); }
+    void reverse() { out.record(Op::Reverse); list.reverse(); }
+    int sum() { out.record(Op::Sum); return list.sum(); }
+    int size() { out.record(Op::Size); return list.size(); }
+};
+
+class RecordingDoublyList {
+private:
+    DoublyLinkedList& list;
+    TraceWriter& out;
+
+public:
+    RecordingDoublyList(DoublyLinkedList& l, TraceWriter& w): list(l), out(w) {}
+
+    bool empty() const { return list.empty(); }
+    int front() const { return list.front(); }
+    int back() const { return list.back(); }
+    void addFront(int i) { out.record(Op::AddFront, i); list.addFront(i); }
+    void addBack(int i) { out.record(Op::AddBack, i); list.addBack(i); }
+    void removeFront() { out.record(Op::RemoveFront); list.removeFront(); }
+    void removeBack() { out.record(Op::RemoveBack); list.removeBack(); }
+    // DoublyLinkedList has no removeAll; recorded as one and replayed via remove_if
+    int removeAll(int x) {
+        out.record(Op::RemoveAll, x);
+        return list.remove_if([x](int v) { return v == x; });
+    }
+    bool isPalindrome() { out.record(Op::IsPalindrome); return list.isPalindrome(); }
+    int size() { out.record(Op::Size); return list.size(); }
+};
+
+// sink collects return values so replays can't be optimized away.
+inline void replayRecord(IntLinkedList& list, const TraceRecord& r, long long& sink) {
+    switch (r.op) {
+    case Op::AddFront: list.addFront(r.arg); break;
+    case Op::AddBack: list.addBack(r.arg); break;
+    case Op::RemoveFront: list.removeFront(); break;
+    case Op::RemoveBack: list.removeBack(); break;
+    case Op::RemoveAll: sink += list.removeAll(r.arg); break;
+    case Op::Reverse: list.reverse(); break;
+    case Op::Sum: sink += list.sum(); break;
+    case Op::Size: sink += list.size(); break;
+    case Op::IsPalindrome: break; // not an IntLinkedList operation
+    }
+}
+
+template <QueueBackend List>
+void replayRecord(List& list, const TraceRecord& r, long long& sink) {
+    int x = r.arg;
+    switch (r.op) {
+    case Op::AddFront: list.addFront(x); break;
+    case Op::AddBack: list.addBack(x); break;
+    case Op::RemoveFront: list.removeFront(); break;
+    case Op::RemoveBack: list.removeBack(); break;
+    case Op::RemoveAll: sink += list.remove_if([x](int v) { return v == x; }); break;
+    case Op::IsPalindrome: sink += list.isPalindrome(); break;
+    case Op::Size: sink += list.size(); break;
+    case Op::Reverse:
+    case Op::Sum: break; // not queue operations
+    }
+}
@@ -0,0 +1,146 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <sys/resource.h>
+#include "recorder.h"
+#include "stats.h"
+using namespace std;
+
+// Peak RSS tracking. On Linux the high-water mark can be reset between
+// backends; elsewhere we fall back to the process-wide maximum.
+void resetPeakMemory() {
+    ofstream clear("/proc/self/clear_refs");
+    if (clear) clear << "5";
+}
+
+long peakMemoryKb() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) return stol(line.substr(6));
+    }
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// One right-aligned column; negative values weren't measured.
+void cell(int width, double value) {
+    if (value < 0) cout << setw(width) << "n/a";
+    else cout << setw(width) << value;
+}
+
+template <typename List>
+void replayOn(const string& name, const Trace& trace, List* list) {
+    resetPeakMemory();
+    vector<long long> latency(trace.records.size());
+    long long sink = 0;
+
+    auto start = chrono::steady_clock::now();
+    for (size_t i = 0; i < trace.records.size(); i++) {
+        auto t0 = chrono::steady_clock::now();
+        replayRecord(*list, trace.records[i], sink);
+        auto t1 = chrono::steady_clock::now();
+        latency[i] = chrono::duration_cast<chrono::nanoseconds>(t1 - t0).count();
+    }
+    delete list;
+    Reclaimer::instance().drain();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << left << setw(22) << name << right << fixed << setprecision(0);
+    cell(14, opsPerSecond(trace.records.size(), seconds));
+    cell(10, percentile(latency, 0.50));
+    cell(10, percentile(latency, 0.99));
+    cell(10, percentile(latency, 0.999));
+    cout << setw(12) << peakMemoryKb() / 1024.0
+         << "   (checksum " << sink << ")" << endl;
+}
+
+void replayAll(const Trace& trace) {
+    cout << trace.records.size() << " ops, "
+         << (trace.kind == ListKind::Singly ? "IntLinkedList" : "DoublyLinkedList") << " trace\n\n";
+    cout << left << setw(22) << "backend" << right << setw(14) << "ops/s"
+         << setw(10) << "p50 ns" << setw(10) << "p99 ns" << setw(10) << "p99.9 ns"
+         << setw(12) << "peak MB" << endl;
+    cout << setprecision(1);
+
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Deferred,
+                           NodeStorage::Background, NodeStorage::Pool, NodeStorage::ThreadCache};
+    string names[] = {"node (heap)", "node (deferred)", "node (background)", "pooled", "thread cache"};
+    for (int m = 0; m < 5; m++) {
+        if (trace.kind == ListKind::Singly) {
+            replayOn(names[m], trace, new IntLinkedList(modes[m]));
+        } else {
+            replayOn(names[m], trace, new DoublyLinkedList(modes[m]));
+        }
+    }
+    if (trace.kind == ListKind::Doubly) replayOn("ring buffer", trace, new RingDeque);
+}
+
+// Writes a synthetic mixed workload through the recording wrappers.
+template <typename Recorder>
+void synthesize(Recorder& list, int ops, unsigned seed) {
+    mt19937 rng(seed);
+    for (int i = 0; i < ops; i++) {
+        int dice = rng() % 100;
+        int value = rng() % 64;
+        if (dice < 25) list.addFront(value);
+        else if (dice < 50) list.addBack(value);
+        else if (dice < 65) list.removeFront();
+        else if (dice < 75) list.removeBack();
+        else if (dice < 80) list.removeAll(value);
+        else if (dice < 90) list.size();
+        else if constexpr (is_same_v<Recorder, RecordingIntList>) {
+            if (dice < 91) list.reverse();
+            else list.sum();
+        } else {
+            list.isPalindrome();
+        }
+    }
+}
+
+void usage() {
+    cerr << "usage: replay <trace>\n"
+         << "       replay --synth <trace> singly|doubly [ops] [seed]\n";
+}
+
+int main(int argc, char** argv) {
+    try {
+        if (argc >= 4 && string(argv[1]) == "--synth") {
+            string kind = argv[3];
+            if (kind != "singly" && kind != "doubly") {
+                usage();
+                return 2;
+            }
+            bool singly = kind == "singly";
+            int ops = argc > 4 ? stoi(argv[4]) : 100000;
+            unsigned seed = argc > 5 ? stoul(argv[5]) : 1;
+            TraceWriter out(argv[2], singly ? ListKind::Singly : ListKind::Doubly);
+            if (singly) {
+                IntLinkedList list;
+                RecordingIntList rec(list, out);
+                synthesize(rec, ops, seed);
+            } else {
+                DoublyLinkedList list;
+                RecordingDoublyList rec(list, out);
+                synthesize(rec, ops, seed);
+            }
+            return 0;
+        }
+        if (argc != 2) {
+            usage();
+            return 2;
+        }
+        replayAll(readTrace(argv[1]));
+    } catch (const exception& e) {
+        cerr << "replay: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
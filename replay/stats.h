@@ -0,0 +1,21 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Summaries of one replay. Both return -1 when there is nothing to
+// measure (an empty trace, or a run too short for the clock), which
+// the report prints as n/a.
+
+// The p-th percentile (p in [0, 1]) of the samples; reorders them.
+inline double percentile(std::vector<long long>& v, double p) {
+    if (v.empty()) return -1;
+    std::size_t k = std::min(v.size() - 1, std::size_t(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return double(v[k]);
+}
+
+inline double opsPerSecond(std::size_t ops, double seconds) {
+    if (ops == 0 || seconds <= 0) return -1;
+    return ops / seconds;
+}
@@ -0,0 +1,152 @@
+#include <iostream>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "recorder.h"
+#include "stats.h"
+using namespace std;
+
+class TestRunner {
+private:
+    int passed = 0;
+    int failed = 0;
+
+public:
+    void test(const string& name, bool condition) {
+        if (condition) {
+            cout << "✓ " << name << endl;
+            passed++;
+        } else {
+            cout << "✗ " << name << endl;
+            failed++;
+        }
+    }
+
+    int failures() const {
+        return failed;
+    }
+
+    void summary() {
+        cout << "\n=== Test Summary ===" << endl;
+        cout << "Passed: " << passed << endl;
+        cout << "Failed: " << failed << endl;
+        cout << "Total: " << (passed + failed) << endl;
+    }
+};
+
+const string path = "replay_test.trc";
+
+void testRoundTrip(TestRunner& t) {
+    cout << "\n--- Trace Round Trip ---" << endl;
+
+    int values[] = {0, 1, -1, 63, 64, -65, 2147483647, -2147483647 - 1};
+    {
+        TraceWriter out(path, ListKind::Doubly);
+        for (int v : values) out.record(Op::AddBack, v);
+        out.record(Op::IsPalindrome);
+        out.record(Op::RemoveAll, -1);
+    }
+    Trace trace = readTrace(path);
+    t.test("Kind survives", trace.kind == ListKind::Doubly);
+    t.test("Record count survives", trace.records.size() == 10);
+    bool same = true;
+    for (int i = 0; i < 8; i++) {
+        same = same && trace.records[i].op == Op::AddBack && trace.records[i].arg == values[i];
+    }
+    t.test("Arguments survive, including INT_MIN/INT_MAX", same);
+    t.test("Argument-less op", trace.records[8].op == Op::IsPalindrome);
+    t.test("Negative argument", trace.records[9].arg == -1);
+
+    FILE* f = fopen(path.c_str(), "wb");
+    fputs("nope", f);
+    fclose(f);
+    bool threw = false;
+    try {
+        readTrace(path);
+    } catch (const exception&) {
+        threw = true;
+    }
+    t.test("Rejects a file that isn't a trace", threw);
+}
+
+void testRecordReplay(TestRunner& t) {
+    cout << "\n--- Record and Replay ---" << endl;
+
+    IntLinkedList original;
+    {
+        TraceWriter out(path, ListKind::Singly);
+        RecordingIntList rec(original, out);
+        for (int i = 0; i < 200; i++) {
+            if (i % 3 == 0) rec.addFront(i % 7);
+            else rec.addBack(i % 5);
+            if (i % 11 == 0) rec.removeFront();
+            if (i % 13 == 0) rec.removeBack();
+        }
+        rec.removeAll(2);
+        rec.reverse();
+        rec.sum();
+    }
+
+    Trace trace = readTrace(path);
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Pool};
+    for (NodeStorage mode : modes) {
+        IntLinkedList copy(mode);
+        long long sink = 0;
+        for (const TraceRecord& r : trace.records) replayRecord(copy, r, sink);
+        t.test("Replayed IntLinkedList matches the original",
+               copy.size() == original.size() && copy.sum() == original.sum());
+    }
+
+    DoublyLinkedList dll;
+    {
+        TraceWriter out(path, ListKind::Doubly);
+        RecordingDoublyList rec(dll, out);
+        for (int i = 0; i < 100; i++) {
+            rec.addBack(i % 4);
+            rec.addFront(i % 4);
+        }
+        rec.removeAll(3);
+        rec.removeBack();
+        rec.isPalindrome();
+    }
+    trace = readTrace(path);
+    DoublyLinkedList copy;
+    long long sink = 0;
+    for (const TraceRecord& r : trace.records) replayRecord(copy, r, sink);
+    t.test("Replayed DoublyLinkedList matches the original",
+           copy.size() == dll.size() && copy.front() == dll.front() && copy.back() == dll.back());
+    remove(path.c_str());
+}
+
+void testEmptyTrace(TestRunner& t) {
+    cout << "\n--- Header-only Trace ---" << endl;
+
+    { TraceWriter out(path, ListKind::Singly); }
+    Trace trace = readTrace(path);
+    t.test("Header-only trace reads as zero records", trace.kind == ListKind::Singly && trace.records.empty());
+
+    IntLinkedList list;
+    long long sink = 0;
+    for (const TraceRecord& r : trace.records) replayRecord(list, r, sink);
+    vector<long long> latency(trace.records.size());
+    t.test("No latencies: percentiles are n/a",
+           percentile(latency, 0.5) < 0 && percentile(latency, 0.999) < 0 && list.empty());
+    t.test("No ops or no time: throughput is n/a", opsPerSecond(0, 1.0) < 0 && opsPerSecond(10, 0.0) < 0);
+
+    vector<long long> some = {40, 10, 30, 20};
+    t.test("Percentiles of a few samples", percentile(some, 0.0) == 10 && percentile(some, 0.5) == 30 &&
+                                            percentile(some, 0.999) == 40 && opsPerSecond(4, 2.0) == 2);
+    remove(path.c_str());
+}
+
+int main() {
+    TestRunner t;
+
+    testRoundTrip(t);
+    testRecordReplay(t);
+    testEmptyTrace(t);
+
+    t.summary();
+
+    return t.failures() > 0 ? 1 : 0;
+}
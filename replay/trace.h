@@ -0,0 +1,121 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Binary trace of list operations.
+//
+//   header: "LTRC" | version (1 byte) | list kind (1 byte)
+//   record: opcode (1 byte) [| argument as zigzag varint]
+//
+// Only ops that take a value carry an argument, so most records are
+// one or two bytes.
+
+enum class ListKind : uint8_t { Singly = 0, Doubly = 1 };
+
+enum class Op : uint8_t {
+    AddFront = 1,
+    AddBack,
+    RemoveFront,
+    RemoveBack,
+    RemoveAll,
+    Reverse,
+    Sum,
+    IsPalindrome,
+    Size
+};
+
+inline bool hasArgument(Op op) {
+    return op == Op::AddFront || op == Op::AddBack || op == Op::RemoveAll;
+}
+
+struct TraceRecord {
+    Op op;
+    int arg;
+};
+
+class TraceWriter {
+private:
+    static const uint8_t version = 1;
+    FILE* out;
+
+    void put(uint8_t b) {
+        if (fputc(b, out) == EOF) throw std::runtime_error("trace write failed");
+    }
+
+public:
+    TraceWriter(const std::string& path, ListKind kind) {
+        out = fopen(path.c_str(), "wb");
+        if (!out) throw std::runtime_error("can't open " + path);
+        fwrite("LTRC", 1, 4, out);
+        put(version);
+        put(uint8_t(kind));
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    ~TraceWriter() {
+        fclose(out);
+    }
+
+    void record(Op op, int arg = 0) {
+        put(uint8_t(op));
+        if (!hasArgument(op)) return;
+        uint32_t z = (uint32_t(arg) << 1) ^ uint32_t(arg >> 31);
+        while (z >= 0x80) {
+            put(uint8_t(z | 0x80));
+            z >>= 7;
+        }
+        put(uint8_t(z));
+    }
+};
+
+struct Trace {
+    ListKind kind;
+    std::vector<TraceRecord> records;
+};
+
+inline Trace readTrace(const std::string& path) {
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) throw std::runtime_error("can't open " + path);
+
+    char magic[4];
+    int version = 0;
+    int kind = 0;
+    if (fread(magic, 1, 4, in) != 4 || std::string(magic, 4) != "LTRC" ||
+        (version = fgetc(in)) != 1 || (kind = fgetc(in)) == EOF || kind > 1) {
+        fclose(in);
+        throw std::runtime_error(path + " is not a list trace");
+    }
+
+    Trace trace {ListKind(kind), {}};
+    int c;
+    while ((c = fgetc(in)) != EOF) {
+        TraceRecord r {Op(c), 0};
+        if (c < int(Op::AddFront) || c > int(Op::Size)) {
+            fclose(in);
+            throw std::runtime_error("bad opcode in " + path);
+        }
+        if (hasArgument(r.op)) {
+            uint32_t z = 0;
+            int shift = 0;
+            int b;
+            do {
+                b = fgetc(in);
+                if (b == EOF || shift > 28) {
+                    fclose(in);
+                    throw std::runtime_error("truncated trace " + path);
+                }
+                z |= uint32_t(b & 0x7f) << shift;
+                shift += 7;
+            } while (b & 0x80);
+            r.arg = int((z >> 1) ^ (~(z & 1) + 1));
+        }
+        trace.records.push_back(r);
+    }
+    fclose(in);
+    return trace;
+}
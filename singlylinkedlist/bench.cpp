@@ -0,0 +1,545 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include "ldlist.h"
+#include "plist.h"
+#include "merge.h"
+#include "rlelist.h"
+#include "islist.h"
+#include <thread>
+#include "../common/perfcounter.h"
+#include "../common/benchrunner.h"
+using namespace std;
+
+template <typename F>
+double timeMs(F f) {
+    auto start = chrono::steady_clock::now();
+    f();
+    auto end = chrono::steady_clock::now();
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+void report(const string& name, double ms) {
+    cout << name << ": " << ms << " ms" << endl;
+}
+
+// Writers keep pushing/popping at the front, readers take a snapshot
+// every `readEvery` writes and sum it. The baseline has to deep-copy
+// the IntLinkedList by hand, which is what readers do today.
+void benchSnapshots(int initial, int writes, int readEvery) {
+    cout << "\n--- Snapshot mix: " << initial << " nodes, "
+         << writes << " writes, snapshot every " << readEvery << " ---" << endl;
+
+    long long sink = 0;
+
+    double copyMs = timeMs([&] {
+        IntLinkedList list;
+        vector<int> mirror; // front of the list is the back of the vector
+        for (int i = 0; i < initial; i++) {
+            list.addFront(i);
+            mirror.push_back(i);
+        }
+        for (int w = 0; w < writes; w++) {
+            if (w % 2 == 0) {
+                list.addFront(w);
+                mirror.push_back(w);
+            } else {
+                list.removeFront();
+                mirror.pop_back();
+            }
+            if (w % readEvery == 0) {
+                IntLinkedList copy;
+                for (int v : mirror) copy.addFront(v);
+                sink += copy.sum();
+            }
+        }
+    });
+    report("IntLinkedList + deep copy", copyMs);
+
+    double persistentMs = timeMs([&] {
+        PersistentIntList list;
+        for (int i = 0; i < initial; i++) {
+            list.addFront(i);
+        }
+        for (int w = 0; w < writes; w++) {
+            if (w % 2 == 0) list.addFront(w);
+            else list.removeFront();
+            if (w % readEvery == 0) {
+                PersistentIntList snap = list.snapshot();
+                sink += snap.sum();
+            }
+        }
+    });
+    report("PersistentIntList + snapshot", persistentMs);
+
+    // Snapshot cost alone, without the read
+    double snapOnlyMs = timeMs([&] {
+        PersistentIntList list;
+        for (int i = 0; i < initial; i++) {
+            list.addFront(i);
+        }
+        for (int w = 0; w < writes; w++) {
+            if (w % 2 == 0) list.addFront(w);
+            else list.removeFront();
+            if (w % readEvery == 0) {
+                PersistentIntList snap = list.snapshot();
+                sink += snap.size();
+            }
+        }
+    });
+    report("PersistentIntList snapshot only", snapOnlyMs);
+
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+// testMemoryStress-style cleanup: removeAll once per value versus
+// a single removeAllOf pass over the whole list.
+void benchRemoveMany(int n, int distinct) {
+    cout << "\n--- Remove " << distinct << " values from " << n << " nodes ---" << endl;
+
+    vector<int> targets;
+    for (int v = 0; v < distinct; v++) targets.push_back(v);
+
+    double loopMs = timeMs([&] {
+        IntLinkedList list;
+        for (int i = 0; i < n; i++) list.addFront(i % (distinct * 2));
+        for (int v : targets) list.removeAll(v);
+    });
+    report("removeAll per value", loopMs);
+
+    double batchMs = timeMs([&] {
+        IntLinkedList list;
+        for (int i = 0; i < n; i++) list.addFront(i % (distinct * 2));
+        list.removeAllOf(targets);
+    });
+    report("removeAllOf", batchMs);
+}
+
+// Destructor time and removeAll throughput for each node storage mode.
+// Background teardown only hands the chain off; the drain line shows
+// when the Reclaimer thread actually finished freeing it.
+void benchStorage(int n) {
+    cout << "\n--- Storage modes, " << n << " nodes ---" << endl;
+
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Deferred,
+                           NodeStorage::Background, NodeStorage::Pool, NodeStorage::ThreadCache};
+    string names[] = {"Heap", "Deferred", "Background", "Pool", "ThreadCache"};
+
+    for (int m = 0; m < 5; m++) {
+        IntLinkedList* list = new IntLinkedList(modes[m]);
+        for (int i = 0; i < n; i++) list->addFront(i % 4);
+
+        int removed = 0;
+        double removeMs = timeMs([&] { removed = list->removeAll(1); });
+        report(names[m] + " removeAll (" + to_string(removed) + " nodes)", removeMs);
+
+        report(names[m] + " destructor", timeMs([&] { delete list; }));
+        if (modes[m] == NodeStorage::Background) {
+            report(names[m] + " drain", timeMs([] { Reclaimer::instance().drain(); }));
+        }
+    }
+}
+
+// Random riffles by relinking: node addresses end up in no particular
+// relation to list order, like a list after a long mixed workload.
+void scatter(IntLinkedList& list, int rounds) {
+    mt19937 rng(42);
+    IntLinkedList rest;
+    for (int r = 0; r < rounds; r++) {
+        list.partition([&rng](int) { return rng() & 1; }, rest);
+        rest.partition([](int) { return false; }, list);
+    }
+}
+
+// Traversal speed on a scattered list before and after compact(),
+// plus the worst single compactStep() pause.
+void benchCompact(int n) {
+    cout << "\n--- Compaction, " << n << " nodes ---" << endl;
+
+    IntLinkedList list;
+    for (int i = 0; i < n; i++) list.addFront(i);
+    scatter(list, 10);
+
+    long long sink = 0;
+    cout << "fragmentation before: " << list.fragmentation() << endl;
+    report("size+sum scattered", timeMs([&] { sink += list.size() + list.sum(); }));
+    report("compact()", timeMs([&] { list.compact(); }));
+    cout << "fragmentation after: " << list.fragmentation() << endl;
+    report("size+sum compacted", timeMs([&] { sink += list.size() + list.sum(); }));
+
+    scatter(list, 10);
+    vector<double> pauses;
+    bool done = false;
+    while (!done) {
+        pauses.push_back(timeMs([&] { done = list.compactStep(10000); }));
+    }
+    sort(pauses.begin(), pauses.end());
+    report("compactStep(10000) median", pauses[pauses.size() / 2]);
+    report("compactStep(10000) worst", pauses.back());
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+// k sorted lists holding `total` values between them.
+vector<IntLinkedList*> sortedInputs(int k, int total) {
+    mt19937 rng(k);
+    vector<IntLinkedList*> lists;
+    for (int i = 0; i < k; i++) {
+        vector<int> values(total / k);
+        for (int& v : values) v = rng() % 1000000;
+        sort(values.begin(), values.end(), greater<int>());
+        IntLinkedList* list = new IntLinkedList;
+        for (int v : values) list->addFront(v);
+        lists.push_back(list);
+    }
+    return lists;
+}
+
+// Gather-sort-rebuild (what the batch job does now), folding the lists
+// in one at a time, the loser-tree k-way merge, and the pairwise merge
+// tree on all hardware threads.
+void benchMerge(int total) {
+    cout << "\n--- Merging k sorted lists, " << total << " values in all ---" << endl;
+    int threads = max(1u, thread::hardware_concurrency());
+
+    for (int k = 2; k <= 1024; k *= 2) {
+        cout << "k = " << k << endl;
+        long long sink = 0;
+
+        vector<IntLinkedList*> lists = sortedInputs(k, total);
+        IntLinkedList out;
+        report("  gather + sort + rebuild", timeMs([&] {
+            vector<int> values;
+            for (IntLinkedList* list : lists) {
+                list->remove_if([&values](int v) { values.push_back(v); return true; });
+            }
+            sort(values.begin(), values.end());
+            for (int i = int(values.size()) - 1; i >= 0; i--) out.addFront(values[i]);
+        }));
+        sink += out.size();
+        for (IntLinkedList* list : lists) delete list;
+
+        if (k <= 64) { // quadratic in k
+            lists = sortedInputs(k, total);
+            IntLinkedList folded;
+            report("  pairwise fold", timeMs([&] {
+                for (IntLinkedList* list : lists) ListMerge::merge(folded, *list);
+            }));
+            sink += folded.size();
+            for (IntLinkedList* list : lists) delete list;
+        }
+
+        lists = sortedInputs(k, total);
+        IntLinkedList merged;
+        report("  k-way merge", timeMs([&] { ListMerge::merge(lists, merged); }));
+        sink += merged.size();
+        for (IntLinkedList* list : lists) delete list;
+
+        lists = sortedInputs(k, total);
+        IntLinkedList tree;
+        report("  merge tree, " + to_string(threads) + " threads",
+               timeMs([&] { ListMerge::mergeParallel(lists, tree, threads); }));
+        sink += tree.size();
+        for (IntLinkedList* list : lists) delete list;
+        cout << "  (checksum " << sink << ")" << endl;
+    }
+}
+
+struct LooseNode {
+    int elem;
+    LooseNode* next;
+};
+
+// The validation stage as it runs today: size(), Floyd, then the
+// two-pointer walks for the middle and the k-th from the end.
+long long separatePasses(LooseNode* head, int k) {
+    long long n = 0;
+    for (LooseNode* h = head; h; h = h->next) n++;
+
+    bool cyclic = false;
+    LooseNode* slow = head;
+    LooseNode* fast = head;
+    while (fast && fast->next) {
+        slow = slow->next;
+        fast = fast->next->next;
+        if (slow == fast) {
+            cyclic = true;
+            break;
+        }
+    }
+
+    slow = fast = head;
+    while (fast && fast->next) {
+        slow = slow->next;
+        fast = fast->next->next;
+    }
+    int middle = slow->elem;
+
+    LooseNode* lead = head;
+    for (int i = 0; i < k; i++) lead = lead->next;
+    LooseNode* trail = head;
+    while (lead) {
+        lead = lead->next;
+        trail = trail->next;
+    }
+    return n + cyclic + middle + trail->elem;
+}
+
+void benchAnalysis(long long n) {
+    cout << "\n--- Chain analysis, " << n << " nodes ---" << endl;
+    long long sink = 0;
+    {
+        vector<LooseNode> chain(n);
+        for (long long i = 0; i < n; i++) chain[i] = {int(i), i + 1 < n ? &chain[i + 1] : nullptr};
+
+        report("size + Floyd + middle + kth, separate passes",
+               timeMs([&] { sink += separatePasses(&chain[0], 1000); }));
+        ChainAnalysis<LooseNode> a;
+        report("ChainAnalysis one pass", timeMs([&] { a.run(&chain[0]); }));
+        report("  then middle + kth", timeMs([&] {
+            sink += a.at(a.shape().nodes / 2)->elem + a.at(a.shape().nodes - 1000)->elem;
+        }));
+    }
+
+    IntLinkedList list(NodeStorage::Pool);
+    for (long long i = 0; i < n / 10; i++) list.addFront(int(i));
+    report("IntLinkedList first middle() (" + to_string(n / 10) + " nodes)",
+           timeMs([&] { sink += list.middle(); }));
+    report("  next 1000 queries, unchanged list", timeMs([&] {
+        for (int k = 1; k <= 1000; k++) sink += list.kthFromEnd(k) + list.hasCycle() + list.size();
+    }));
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+// Millions of short-lived short lists. Up to listInlineNodes nodes
+// live inside the list object; the baseline allocates every node, as
+// all lists did before.
+void benchSmallLists(int lists) {
+    cout << "\n--- " << lists << " short-lived small lists ---" << endl;
+    struct HeapNode {
+        int elem;
+        HeapNode* next;
+    };
+    long long sink = 0;
+    for (int size : {4, 8, 16, 20}) {
+        report("node per allocation, " + to_string(size) + " nodes", timeMs([&] {
+            for (int l = 0; l < lists; l++) {
+                HeapNode* head = nullptr;
+                for (int i = 0; i < size; i++) head = new HeapNode {i, head};
+                while (head) {
+                    HeapNode* next = head->next;
+                    sink += head->elem;
+                    delete head;
+                    head = next;
+                }
+            }
+        }));
+        report("IntLinkedList, " + to_string(size) + " nodes", timeMs([&] {
+            for (int l = 0; l < lists; l++) {
+                IntLinkedList list;
+                for (int i = 0; i < size; i++) list.addFront(i);
+                sink += list.sum();
+            }
+        }));
+    }
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+// Repetitive data, as in the identical/alternating fixtures and in runs
+// of 1000: build, sum, removeAll, plus node memory (runs vs values).
+void benchRunLength(int n) {
+    cout << "\n--- Run-length encoding, " << n << " values ---" << endl;
+    struct Shape {
+        string name;
+        int (*value)(int);
+    };
+    Shape shapes[] = {
+        {"identical", [](int) { return 7; }},
+        {"runs of 1000", [](int i) { return i / 1000 % 10; }},
+        {"alternating", [](int i) { return i % 2; }},
+    };
+    long long sink = 0;
+    for (const Shape& shape : shapes) {
+        IntLinkedList plain(NodeStorage::Pool);
+        RunLengthIntList packed(NodeStorage::Pool);
+        report("IntLinkedList build, " + shape.name, timeMs([&] {
+            for (int i = n - 1; i >= 0; i--) plain.addFront(shape.value(i));
+        }));
+        report("RunLengthIntList build, " + shape.name, timeMs([&] {
+            for (int i = 0; i < n; i++) packed.addBack(shape.value(i));
+        }));
+        report("IntLinkedList sum", timeMs([&] { sink += plain.sum(); }));
+        report("RunLengthIntList sum", timeMs([&] { sink += packed.sum(); }));
+        cout << "node memory: " << n * sizeof(IntNode) << " vs "
+             << packed.runs() * sizeof(RunNode) << " bytes" << endl;
+        report("IntLinkedList removeAll", timeMs([&] { sink += plain.removeAll(7) + plain.removeAll(0); }));
+        report("RunLengthIntList removeAll", timeMs([&] { sink += packed.removeAll(7) + packed.removeAll(0); }));
+    }
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+// Cold lists: node memory against the frozen copy, and sum() scans
+// (as values per ns) on each, for timestamps-like slowly rising data
+// and for random values.
+void benchFreeze(int n) {
+    cout << "\n--- Frozen lists, " << n << " values ---" << endl;
+    mt19937 rng(3);
+    long long sink = 0;
+    for (bool random : {false, true}) {
+        string shape = random ? "random" : "rising";
+        IntLinkedList list;
+        int v = 0;
+        for (int i = 0; i < n; i++) list.addFront(random ? int(rng()) : (v += rng() % 100));
+        scatter(list, 2);
+
+        int listSum = 0;
+        double listMs = timeMs([&] { listSum = list.sum(); });
+        FrozenIntList frozen;
+        report("freeze, " + shape, timeMs([&] { frozen = list.freeze(); }));
+        int frozenSum = 0;
+        double frozenMs = timeMs([&] { frozenSum = frozen.sum(); });
+        cout << "memory: " << (long long)n * sizeof(IntNode) << " bytes of nodes vs "
+             << frozen.memory() << " frozen" << endl;
+        report("IntLinkedList sum (" + to_string(int(n / listMs / 1000)) + " M values/s)", listMs);
+        report("FrozenIntList sum (" + to_string(int(n / frozenMs / 1000)) + " M values/s)", frozenMs);
+        report("thaw", timeMs([&] { list.thaw(frozen); }));
+        sink += listSum + frozenSum;
+    }
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+double percentile(vector<long long>& v, double p) {
+    size_t k = min(v.size() - 1, size_t(p * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return double(v[k]);
+}
+
+// A request loop (addFront + removeFront per request) on an n-node list
+// that also has to drop every 3 and finally go away. Done in one go,
+// one request eats the whole removeAll and the last the destructor;
+// done in steps of `budget`, the work spreads over many requests.
+void benchLatency(int n, int requests, int budget) {
+    cout << "\n--- Request latency, " << n << " nodes, budget " << budget << " ---" << endl;
+    for (bool incremental : {false, true}) {
+        IntLinkedList* list = new IntLinkedList(NodeStorage::Deferred);
+        for (int i = 0; i < n; i++) list->addFront(i % 10);
+        vector<long long> ns;
+        ns.reserve(requests);
+        int removed = 0;
+        bool removing = true;
+        for (int r = 0; r < requests; r++) {
+            auto start = chrono::steady_clock::now();
+            list->addFront(r % 10);
+            list->removeFront();
+            if (removing && r >= requests / 10) {
+                if (incremental) {
+                    removing = !list->removeAllStep(3, budget, removed);
+                } else {
+                    removed = list->removeAll(3);
+                    removing = false;
+                }
+            } else if (!removing && r >= requests / 2 && !list->empty()) {
+                if (incremental) {
+                    list->clearStep(budget);
+                } else {
+                    delete list;
+                    list = new IntLinkedList(NodeStorage::Deferred);
+                }
+            }
+            ns.push_back(chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count());
+        }
+        long long worst = *max_element(ns.begin(), ns.end());
+        cout << (incremental ? "removeAllStep + clearStep" : "removeAll + destructor")
+             << ": p50 " << percentile(ns, 0.5) << " ns, p99 " << percentile(ns, 0.99)
+             << " ns, p99.9 " << percentile(ns, 0.999) << " ns, max " << worst / 1e6 << " ms"
+             << " (removed " << removed << ", " << list->size() << " left)" << endl;
+        delete list;
+    }
+}
+
+// A stack of caller-owned objects, filled and drained in rounds: one
+// node allocation and free per value for IntLinkedList, none for the
+// intrusive list, which links the objects themselves.
+void benchIntrusive(int n, int rounds) {
+    cout << "\n--- Stack of " << n << " objects, " << rounds << " rounds ---" << endl;
+    struct Packet : SListHook<> {
+        int bytes;
+    };
+    vector<Packet> packets(n);
+    for (int i = 0; i < n; i++) packets[i].bytes = i % 1500;
+    long long sink = 0;
+
+    report("IntLinkedList", timeMs([&] {
+        IntLinkedList stack;
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < n; i++) stack.addFront(packets[i].bytes);
+            sink += stack.sum();
+            while (!stack.empty()) stack.removeFront();
+        }
+    }));
+    report("IntrusiveSList", timeMs([&] {
+        IntrusiveSList<Packet> stack;
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < n; i++) stack.addFront(packets[i]);
+            stack.forEach([&sink](Packet& p) { sink -= p.bytes; });
+            while (!stack.empty()) stack.removeFront();
+        }
+    }));
+    cout << "(difference " << sink << ", 0 if both agree)" << endl;
+}
+
+// sum, reverse and removeAll under the hardware counters, on a
+// scattered list and again once it is compacted: what changes between
+// the two is cache behaviour, not work.
+void benchCounters(int n) {
+    cout << "\n--- Counters: " << n << " nodes, scattered vs compacted ---" << endl;
+    IntLinkedList list;
+    for (int i = 0; i < n; i++) list.addFront(i % 10);
+    scatter(list, 10);
+
+    BenchRunner runner;
+    long long sink = 0;
+    for (string layout : {"scattered", "compacted"}) {
+        if (layout == "compacted") list.compact();
+        runner.run("sum, " + layout, [&] { sink += list.sum(); });
+        runner.run("reverse, " + layout, [&] { list.reverse(); });
+        runner.run("removeAll (no match), " + layout, [&] { sink += list.removeAll(-1); });
+    }
+    runner.run("removeAll(3), compacted", [&] { sink += list.removeAll(3); });
+    runner.summary();
+    cout << "(checksum " << sink << ")" << endl;
+}
+
+int main() {
+    cout << "=== IntLinkedList Benchmarks ===" << endl;
+
+    benchSnapshots(10000, 10000, 10);
+    benchSnapshots(10000, 10000, 100);
+    benchSnapshots(100000, 10000, 1000);
+
+    benchRemoveMany(100000, 10);
+    benchRemoveMany(100000, 300);
+
+    benchStorage(5000000);
+
+    benchCompact(2000000);
+
+    benchMerge(1 << 20);
+
+    benchAnalysis(100000000);
+
+    benchSmallLists(2000000);
+
+    benchRunLength(5000000);
+
+    benchFreeze(5000000);
+
+    benchLatency(5000000, 2000000, 1024);
+
+    benchIntrusive(1000000, 10);
+
+    benchCounters(2000000);
+
+    return 0;
+}
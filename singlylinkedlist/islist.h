@@ -0,0 +1,184 @@
+#pragma once
+#include <type_traits>
+
+// Intrusive counterpart of IntLinkedList: the caller's objects carry
+// the link, so nothing is allocated or freed on add or remove.
+//
+//   struct Packet : SListHook<> { int bytes; };
+//   Packet ring[256];
+//   IntrusiveSList<Packet> outbox;
+//   outbox.addBack(ring[0]);
+//
+// Objects on several lists at once derive from one hook per list, told
+// apart by tag types (SListHook<Tag>, IntrusiveSList<T, Tag>).
+//
+// The list owns nothing and an object must stay put while it is on
+// one: with a single link there is no O(1) way off a list from the
+// object alone, so removals go through the list. The chain runs from a
+// header sentinel back round to it, which keeps the link of every
+// linked object non-null (linked()) and gives the front object a
+// predecessor like any other, so one unlink covers every position.
+template <typename Tag = void>
+class SListHook {
+private:
+    SListHook* next {nullptr};
+    template <typename, typename> friend class IntrusiveSList;
+
+public:
+    SListHook() = default;
+    // A copy is another object: it starts out on no list
+    SListHook(const SListHook&) {}
+    SListHook& operator=(const SListHook&) { return *this; }
+
+    bool linked() const {
+        return next != nullptr;
+    }
+};
+
+template <typename T, typename Tag = void>
+class IntrusiveSList {
+private:
+    using Hook = SListHook<Tag>;
+    static_assert(std::is_base_of<Hook, T>::value, "T must derive from SListHook<Tag>");
+
+    Hook header;
+    Hook* tail;  // last hook, or &header when empty, for O(1) addBack
+    int count;
+
+    static Hook* hook(T& x) { return static_cast<Hook*>(&x); }
+    static T& object(Hook* h) { return *static_cast<T*>(h); }
+
+    void linkAfter(Hook* prev, Hook* h) {
+        h->next = prev->next;
+        prev->next = h;
+        if (prev == tail) tail = h;
+        count++;
+    }
+
+    void unlinkAfter(Hook* prev) {
+        Hook* h = prev->next;
+        prev->next = h->next;
+        if (h == tail) tail = prev;
+        h->next = nullptr;
+        count--;
+    }
+
+    // The hook whose next is h, by a walk from the front; nullptr if h
+    // isn't on this list.
+    Hook* before(const Hook* h) {
+        for (Hook* prev = &header; prev->next != &header; prev = prev->next) {
+            if (prev->next == h) return prev;
+        }
+        return nullptr;
+    }
+
+public:
+    IntrusiveSList(): tail(&header), count(0) {
+        header.next = &header;
+    }
+    IntrusiveSList(const IntrusiveSList&) = delete;
+    IntrusiveSList& operator=(const IntrusiveSList&) = delete;
+    ~IntrusiveSList() {
+        clear();
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    int size() const {
+        return count;
+    }
+
+    // Both UB on an empty list.
+    T& front() const { return object(header.next); }
+    T& back() const { return object(tail); }
+
+    // x must not be on a list already.
+    void addFront(T& x) {
+        if (hook(x)->linked()) return; // Actually, UB
+        linkAfter(&header, hook(x));
+    }
+
+    void addBack(T& x) {
+        if (hook(x)->linked()) return; // Actually, UB
+        linkAfter(tail, hook(x));
+    }
+
+    // pos must be on this list.
+    void insertAfter(T& pos, T& x) {
+        if (hook(x)->linked()) return; // Actually, UB
+        linkAfter(hook(pos), hook(x));
+    }
+
+    void removeFront() {
+        if (!empty()) unlinkAfter(&header);
+    }
+
+    // O(n), as in IntLinkedList: a walk finds the new tail.
+    void removeBack() {
+        if (!empty()) unlinkAfter(before(tail));
+    }
+
+    // Unlinks the object after pos (on this list), if there is one.
+    void removeAfter(T& pos) {
+        if (hook(pos)->next != &header) unlinkAfter(hook(pos));
+    }
+
+    // O(n). Returns false if x isn't on this list.
+    bool remove(T& x) {
+        Hook* prev = before(hook(x));
+        if (!prev) return false;
+        unlinkAfter(prev);
+        return true;
+    }
+
+    void clear() {
+        Hook* h = header.next;
+        while (h != &header) {
+            Hook* next = h->next;
+            h->next = nullptr;
+            h = next;
+        }
+        header.next = &header;
+        tail = &header;
+        count = 0;
+    }
+
+    // Calls visit(object) front to back; visit must not unlink anything.
+    template <typename F>
+    void forEach(F visit) const {
+        for (Hook* h = header.next; h != &header; h = h->next) {
+            visit(object(h));
+        }
+    }
+
+    // Returns the number of objects unlinked.
+    template <typename Pred>
+    int remove_if(Pred pred) {
+        int removed = 0;
+        Hook* prev = &header;
+        while (prev->next != &header) {
+            if (pred(object(prev->next))) {
+                unlinkAfter(prev);
+                removed++;
+            } else {
+                prev = prev->next;
+            }
+        }
+        return removed;
+    }
+
+    void reverse() {
+        Hook* prev = &header;
+        Hook* current = header.next;
+        tail = current == &header ? &header : current;
+        while (current != &header) {
+            Hook* next = current->next;
+            current->next = prev;
+            prev = current;
+            current = next;
+        }
+        header.next = prev;
+    }
+};
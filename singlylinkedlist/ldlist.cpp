@@ -2,15 +2,14 @@
 #include "ldlist.h"
 using namespace std;
 
+using Walk = ChainWalker<IntNode>;
+
 
 IntLinkedList::IntLinkedList(): head(nullptr) {}
+IntLinkedList::IntLinkedList(NodeStorage storage): head(nullptr), nodes(storage) {}
 IntLinkedList::~IntLinkedList(){
     // My addition
-    while (head) {
-        IntNode* tmp = head;
-        head = head->next;
-        delete tmp;
-    }
+    nodes.dropChain(head);
 }
 
 bool IntLinkedList::empty() const{
@@ -18,16 +17,18 @@ bool IntLinkedList::empty() const{
 }
 
 void IntLinkedList::addFront(int i){
-    IntNode* n = new IntNode();
+    IntNode* n = nodes.create();
     n->elem = i;
     n->next = head;
     head = n;
+    touch();
 }
 
 void IntLinkedList::addBack(int i){
-    IntNode *node = new IntNode();
+    IntNode *node = nodes.create();
     node->elem = i;
     node->next = nullptr;
+    touch();
     if(empty()){
         head = node;
         return;
@@ -40,6 +41,7 @@ void IntLinkedList::addBack(int i){
 }
 
 int IntLinkedList::size() {
+    if (analyzedAt == epoch && !analyzed.shape().cyclic) return analyzed.shape().nodes;
     IntNode* h = head;
     int count = 0;
     while(h != nullptr){
@@ -61,16 +63,122 @@ void IntLinkedList::print(){
     }
 }
 
+// Wraps on overflow, without signed-overflow UB along the way.
 int IntLinkedList::sum() {
     IntNode* h = head;
-    int sum = 0;
+    long long sum = 0;
     while(h!=nullptr){
         sum = sum + h->elem;
         h = h->next;
     }
-    return sum;
+    return int(sum);
 }
 
+// Sums in long long: sum() wraps once the total passes INT_MAX.
 double IntLinkedList::average(){
-    return double(sum()) / size();
+    long long total = 0;
+    int count = 0;
+    for (IntNode* h = head; h != nullptr; h = h->next) {
+        total += h->elem;
+        count++;
+    }
+    return double(total) / count;
+}
+
+void IntLinkedList::reclaim(){
+    nodes.reclaim();
+}
+
+void IntLinkedList::compact(){
+    if (!nodes.relayingOut() && !empty()) {
+        nodes.beginRelayout(size()); // one block for the whole list
+        compactLink = nullptr;
+    }
+    while (!compactStep(1 << 30)) {}
+}
+
+bool IntLinkedList::compactStep(int budget){
+    if (!nodes.relayingOut()) {
+        if (empty()) return true;
+        nodes.beginRelayout(0);
+        compactLink = nullptr;
+    }
+    if (!compactLink) compactLink = &head;
+    removeLink = nullptr;
+    touch(); // nodes move
+    while (*compactLink && budget > 0) {
+        IntNode* moved = nodes.relocate(*compactLink);
+        *compactLink = moved;
+        compactLink = &moved->next;
+        budget--;
+    }
+    if (*compactLink) return false;
+    nodes.endRelayout();
+    compactLink = nullptr;
+    return true;
+}
+
+const ChainAnalysis<IntNode>& IntLinkedList::analysis(){
+    if (analyzedAt != epoch) {
+        analyzed.run(head);
+        analyzedAt = epoch;
+    }
+    return analyzed;
+}
+
+long long IntLinkedList::analysisPasses() const {
+    return analyzed.passes();
+}
+
+const ChainShape& IntLinkedList::shape(){
+    return analysis().shape();
+}
+
+bool IntLinkedList::hasCycle(){
+    return shape().cyclic;
+}
+
+int IntLinkedList::middle(){
+    const ChainAnalysis<IntNode>& a = analysis();
+    if (a.shape().cyclic) return -1;
+    IntNode* n = a.at(a.shape().nodes / 2);
+    return n ? n->elem : -1;
+}
+
+int IntLinkedList::kthFromEnd(int k){
+    const ChainAnalysis<IntNode>& a = analysis();
+    if (a.shape().cyclic || k < 1) return -1;
+    IntNode* n = a.at(a.shape().nodes - k);
+    return n ? n->elem : -1;
+}
+
+FrozenIntList IntLinkedList::freeze(){
+    FrozenIntList::Builder frozen;
+    for (IntNode* h = head; h != nullptr; h = h->next) {
+        frozen.add(h->elem);
+    }
+    resetCursors();
+    touch();
+    nodes.dropChain(head);
+    head = nullptr;
+    return frozen.finish();
+}
+
+void IntLinkedList::thaw(const FrozenIntList& frozen){
+    resetCursors();
+    touch();
+    nodes.dropChain(head);
+    head = nullptr;
+    IntNode** tail = &head;
+    frozen.forEach([&](int v) {
+        IntNode* n = nodes.create();
+        n->elem = v;
+        n->next = nullptr;
+        *tail = n;
+        tail = &n->next;
+    });
+}
+
+double IntLinkedList::fragmentation() const{
+    return Walk::fragmentation(head, nullptr);
 }
@@ -1,4 +1,9 @@
 #pragma once
+#include <span>
+#include "../common/nodealloc.h"
+#include "../common/chainwalk.h"
+#include "../common/chainshape.h"
+#include "../common/frozenlist.h"
 
 class IntNode{
 private:
@@ -6,13 +11,47 @@ private:
     // was: string
     IntNode* next;
     friend class IntLinkedList;
+    friend class PersistentIntList;
+    friend class RunLengthIntList;
+    friend class ListMerge;
+    friend class NodeAllocator<IntNode>;
+    friend struct ChainWalker<IntNode>;
+    friend class ChainAnalysis<IntNode>;
 };
 
 class IntLinkedList{
 private:
     IntNode* head;
+    NodeAllocator<IntNode> nodes;
+    // Where compactStep() and removeAllStep() resume; nullptr restarts
+    // from head. Single removals step them off the freed node
+    // (unlinked()); bulk changes reset both.
+    IntNode** compactLink {nullptr};
+    IntNode** removeLink {nullptr};
+    int removeValue {0};
+    void resetCursors() {
+        compactLink = nullptr;
+        removeLink = nullptr;
+    }
+    // node left the chain through *link: cursors on its next field
+    // move to link.
+    void unlinked(IntNode* node, IntNode** link) {
+        if (compactLink == &node->next) compactLink = link;
+        if (removeLink == &node->next) removeLink = link;
+    }
+    // Bumped by every change to the chain; analysis() is redone only
+    // when it has moved on since the last run.
+    long long epoch {0};
+    long long analyzedAt {-1};
+    ChainAnalysis<IntNode> analyzed;
+    void touch() { epoch++; }
+    const ChainAnalysis<IntNode>& analysis();
+    friend class PersistentIntList;
+    friend class RunLengthIntList;
+    friend class ListMerge;
 public:
     IntLinkedList();
+    explicit IntLinkedList(NodeStorage storage);
     ~IntLinkedList();
     bool empty() const;
     void addFront(int i);
@@ -21,12 +60,137 @@ public:
     void print();
     int sum();
     double average();
+    // Frees nodes parked by the Deferred/Background storage modes.
+    void reclaim();
+
+    // Moves the nodes into contiguous list-owned blocks in list order
+    // (the list uses Pool storage afterwards). compactStep() moves at
+    // most `budget` nodes per call, for idle-time use, and returns true
+    // once the whole list is laid out.
+    void compact();
+    bool compactStep(int budget);
+    double fragmentation() const; // 0 = contiguous, 1 = every hop far away
+
+    // Chain validation, one pass for all of it, cached until the list
+    // changes: repeated queries don't walk again. middle() is the value
+    // at position size() / 2; kthFromEnd(1) is the last value. Both
+    // return -1 when out of range or when the chain loops.
+    const ChainShape& shape();
+    bool hasCycle();
+    int middle();
+    int kthFromEnd(int k);
+    // Walks made for the above so far; unchanged while the cache holds.
+    long long analysisPasses() const;
+
+    // For lists that go read-only: freeze() moves the values into a
+    // compressed FrozenIntList and leaves the list empty; thaw()
+    // replaces the contents with a frozen list's values.
+    FrozenIntList freeze();
+    void thaw(const FrozenIntList& frozen);
 
     // Problems
     
     void removeFront();
     void removeBack();
     int removeAll(int x); // returns the number of nodesremoved
+    int removeAllOf(std::span<const int> values); // any of values, one pass
+    // Latency-bounded removeAll and teardown. Each call looks at no more
+    // than `budget` nodes and returns true once finished; the list stays
+    // valid in between and can be used and changed as usual. Adding and
+    // single removals keep removeAllStep()'s place; bulk changes, and
+    // asking for a different x, restart it at the front (nodes already
+    // checked are checked again, nothing is missed). It adds to `removed`.
+    // clearStep() frees from the front: call it until it returns true
+    // before dropping a huge list (or use Background storage).
+    bool removeAllStep(int x, int budget, int& removed);
+    bool clearStep(int budget);
+    template <typename Pred> int remove_if(Pred pred);
     void reverse();
+
+    // Keep the elements satisfying pred and relink the rest onto `rest`.
+    // Both return how many nodes moved. stable_partition appends them in
+    // order; partition pushes them on rest's front, skipping the tail walk.
+    template <typename Pred> int stable_partition(Pred pred, IntLinkedList& rest);
+    template <typename Pred> int partition(Pred pred, IntLinkedList& rest);
 };
 
+template <typename Pred>
+int IntLinkedList::remove_if(Pred pred) {
+    resetCursors();
+    touch();
+    int count = 0;
+    IntNode** link = &head;
+    while (*link) {
+        IntNode* node = *link;
+        if (pred(node->elem)) {
+            *link = node->next;
+            nodes.destroy(node);
+            count++;
+        } else {
+            link = &node->next;
+        }
+    }
+    return count;
+}
+
+template <typename Pred>
+int IntLinkedList::stable_partition(Pred pred, IntLinkedList& rest) {
+    if (&rest == this) return 0;
+    resetCursors();
+    touch();
+    rest.touch();
+    IntNode** restTail = &rest.head;
+    while (*restTail) restTail = &(*restTail)->next;
+
+    int moved = 0;
+    IntNode** link = &head;
+    while (*link) {
+        IntNode* node = *link;
+        if (pred(node->elem)) {
+            link = &node->next;
+            continue;
+        }
+        *link = node->next;
+        // Nodes that can't change lists are copied across
+        if (!nodes.movable(node, rest.nodes)) {
+            IntNode* copy = rest.nodes.create();
+            copy->elem = node->elem;
+            nodes.destroy(node);
+            node = copy;
+        }
+        node->next = nullptr;
+        *restTail = node;
+        restTail = &node->next;
+        moved++;
+    }
+    return moved;
+}
+
+template <typename Pred>
+int IntLinkedList::partition(Pred pred, IntLinkedList& rest) {
+    if (&rest == this) return 0;
+    resetCursors();
+    touch();
+    rest.touch();
+    int moved = 0;
+    IntNode** link = &head;
+    while (*link) {
+        IntNode* node = *link;
+        if (pred(node->elem)) {
+            link = &node->next;
+            continue;
+        }
+        *link = node->next;
+        // Nodes that can't change lists are copied across
+        if (!nodes.movable(node, rest.nodes)) {
+            IntNode* copy = rest.nodes.create();
+            copy->elem = node->elem;
+            nodes.destroy(node);
+            node = copy;
+        }
+        node->next = rest.head;
+        rest.head = node;
+        moved++;
+    }
+    return moved;
+}
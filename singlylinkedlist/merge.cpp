@@ -0,0 +1,172 @@
+#include <thread>
+#include <vector>
+#include "merge.h"
+#include "ldlist.h"
+using namespace std;
+
+
+
+IntNode** ListMerge::append(IntNode** tail, IntNode* n, IntLinkedList& from, IntLinkedList& to) {
+    if (&from != &to && !from.nodes.movable(n, to.nodes)) {
+        IntNode* copy = to.nodes.create();
+        copy->elem = n->elem;
+        from.nodes.destroy(n);
+        n = copy;
+    }
+    n->next = nullptr;
+    *tail = n;
+    return &n->next;
+}
+
+void ListMerge::merge(span<IntLinkedList* const> lists, IntLinkedList& out) {
+    // Leaf i reads from cursor[i]; out's old chain is leaf 0.
+    vector<IntLinkedList*> owner {&out};
+    vector<IntNode*> cursor {out.head};
+    out.head = nullptr;
+    out.resetCursors();
+    out.touch();
+    for (IntLinkedList* list : lists) {
+        if (list == &out || !list->head) continue;
+        owner.push_back(list);
+        cursor.push_back(list->head);
+        list->head = nullptr;
+        list->resetCursors();
+        list->touch();
+    }
+
+    int k = cursor.size();
+    // Head values are mirrored in key[] so the matches never have to
+    // touch a node; live[] goes false when a leaf runs dry.
+    vector<int> key(k);
+    vector<char> live(k);
+    for (int i = 0; i < k; i++) {
+        live[i] = cursor[i] != nullptr;
+        if (live[i]) key[i] = cursor[i]->elem;
+    }
+    // Does leaf a win against leaf b? Exhausted leaves always lose.
+    auto beats = [&key, &live](int a, int b) {
+        if (!live[b]) return true;
+        if (!live[a]) return false;
+        if (key[a] != key[b]) return key[a] < key[b];
+        return a < b;
+    };
+
+    // Internal nodes 1..k-1 hold the loser of their match, leaves sit
+    // at k..2k-1. Build by playing every match once, bottom up.
+    vector<int> loser(k), winner(2 * k);
+    for (int i = 0; i < k; i++) winner[k + i] = i;
+    for (int n = k - 1; n >= 1; n--) {
+        int l = winner[2 * n], r = winner[2 * n + 1];
+        bool left = beats(l, r);
+        winner[n] = left ? l : r;
+        loser[n] = left ? r : l;
+    }
+    int top = k > 1 ? winner[1] : 0;
+
+    IntNode** tail = &out.head;
+    while (live[top]) {
+        IntNode* n = cursor[top];
+        IntNode* next = n->next;
+        cursor[top] = next;
+        live[top] = next != nullptr;
+        if (next) {
+            key[top] = next->elem;
+        }
+        tail = append(tail, n, *owner[top], out);
+        // Replay the winner's path to the root
+        int w = top;
+        for (int p = (top + k) / 2; p >= 1; p /= 2) {
+            if (beats(loser[p], w)) swap(loser[p], w);
+        }
+        top = w;
+    }
+}
+
+void ListMerge::merge(IntLinkedList& a, IntLinkedList& b) {
+    IntLinkedList* other[] = {&b};
+    merge(other, a);
+}
+
+void ListMerge::mergeParallel(span<IntLinkedList* const> lists, IntLinkedList& out, int threads) {
+    vector<IntLinkedList*> level {&out};
+    for (IntLinkedList* list : lists) {
+        if (list != &out) level.push_back(list);
+    }
+    if (threads < 1) threads = 1;
+
+    // Each level merges list 2i+1 into list 2i; pairs don't share
+    // lists (or allocators), so they can run side by side.
+    while (level.size() > 1) {
+        int pairs = level.size() / 2;
+        auto work = [&level, pairs, threads](int first) {
+            for (int p = first; p < pairs; p += threads) merge(*level[2 * p], *level[2 * p + 1]);
+        };
+        vector<thread> pool;
+        for (int t = 1; t < min(threads, pairs); t++) pool.emplace_back(work, t);
+        work(0);
+        for (thread& t : pool) t.join();
+
+        vector<IntLinkedList*> next;
+        for (size_t i = 0; i < level.size(); i += 2) next.push_back(level[i]);
+        level.swap(next);
+    }
+}
+
+int ListMerge::unite(IntLinkedList& a, IntLinkedList& b) {
+    if (&a == &b) return 0;
+    a.resetCursors();
+    b.resetCursors();
+    a.touch();
+    b.touch();
+    IntNode* x = a.head;
+    IntNode* y = b.head;
+    a.head = nullptr;
+    b.head = nullptr;
+
+    int added = 0;
+    IntNode** tail = &a.head;
+    while (x || y) {
+        if (y && (!x || y->elem < x->elem)) {
+            // Only in b: take it, with all its duplicates
+            int v = y->elem;
+            while (y && y->elem == v) {
+                IntNode* n = y;
+                y = y->next;
+                tail = append(tail, n, b, a);
+                added++;
+            }
+            continue;
+        }
+        int v = x->elem;
+        while (x && x->elem == v) {
+            IntNode* n = x;
+            x = x->next;
+            tail = append(tail, n, a, a);
+        }
+        // Already in a: b's copies are dropped
+        while (y && y->elem == v) {
+            IntNode* n = y;
+            y = y->next;
+            b.nodes.destroy(n);
+        }
+    }
+    return added;
+}
+
+int ListMerge::intersect(IntLinkedList& a, const IntLinkedList& b) {
+    if (&a == &b) return 0;
+    IntNode* y = b.head;
+    return a.remove_if([&y](int v) {
+        while (y && y->elem < v) y = y->next;
+        return !y || y->elem != v;
+    });
+}
+
+int ListMerge::subtract(IntLinkedList& a, const IntLinkedList& b) {
+    if (&a == &b) return a.remove_if([](int) { return true; });
+    IntNode* y = b.head;
+    return a.remove_if([&y](int v) {
+        while (y && y->elem < v) y = y->next;
+        return y && y->elem == v;
+    });
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <span>
+
+class IntLinkedList;
+class IntNode;
+
+// Merging and set operations on lists sorted in ascending order.
+// Nodes are relinked, not copied, unless they can't change lists
+// (see NodeAllocator::movable), as in partition().
+//
+// Set operations go by value, like removeAll(): a value is either in
+// a list or not, however many times it occurs.
+class ListMerge {
+private:
+    // Appends n (unlinked, from `from`) at *tail, copying if it can't move.
+    static IntNode** append(IntNode** tail, IntNode* n, IntLinkedList& from, IntLinkedList& to);
+
+public:
+    // Moves every node of `lists` into `out` in sorted order, through a
+    // tournament (loser) tree: one comparison per tree level per node.
+    // out's own nodes take part as well; ties keep earlier lists first.
+    // The inputs are left empty.
+    static void merge(std::span<IntLinkedList* const> lists, IntLinkedList& out);
+
+    // Moves b's nodes into a, in sorted order. b is left empty.
+    static void merge(IntLinkedList& a, IntLinkedList& b);
+
+    // Same result as merge(lists, out), built as a tree of pairwise
+    // merges whose pairs run on up to `threads` threads per level.
+    static void mergeParallel(std::span<IntLinkedList* const> lists, IntLinkedList& out, int threads);
+
+    // a keeps all its nodes and gains b's nodes whose value isn't in a;
+    // b is left empty. Returns the number of nodes added to a.
+    static int unite(IntLinkedList& a, IntLinkedList& b);
+    // Removes from a every node whose value isn't in b. Returns the count.
+    static int intersect(IntLinkedList& a, const IntLinkedList& b);
+    // Removes from a every node whose value is in b (a.removeAllOf(b)).
+    // Returns the count.
+    static int subtract(IntLinkedList& a, const IntLinkedList& b);
+};
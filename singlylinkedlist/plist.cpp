@@ -0,0 +1,131 @@
+#include <iostream>
+#include "plist.h"
+#include "ldlist.h"
+using namespace std;
+
+
+PersistentIntList::PersistentIntList(): head(nullptr) {}
+
+PersistentIntList::PersistentIntList(PersistentNode* h): head(h) {}
+
+PersistentIntList::PersistentIntList(IntLinkedList& list): head(nullptr) {
+    int n = list.size();
+    PersistentNode* tail = nullptr;
+    for (IntNode* h = list.head; h != nullptr; h = h->next) {
+        PersistentNode* node = new PersistentNode();
+        node->elem = h->elem;
+        node->length = n--;
+        if (tail) tail->next = node;
+        else head = node;
+        tail = node;
+    }
+}
+
+PersistentIntList::PersistentIntList(const PersistentIntList& other): head(other.head) {
+    retain(head);
+}
+
+PersistentIntList::PersistentIntList(PersistentIntList&& other) noexcept: head(other.head) {
+    other.head = nullptr;
+}
+
+PersistentIntList& PersistentIntList::operator=(const PersistentIntList& other) {
+    retain(other.head); // first, in case of self-assignment
+    release(head);
+    head = other.head;
+    return *this;
+}
+
+PersistentIntList& PersistentIntList::operator=(PersistentIntList&& other) noexcept {
+    if (this != &other) {
+        release(head);
+        head = other.head;
+        other.head = nullptr;
+    }
+    return *this;
+}
+
+PersistentIntList::~PersistentIntList() {
+    release(head);
+}
+
+void PersistentIntList::retain(PersistentNode* n) {
+    if (n) n->refs.fetch_add(1, memory_order_relaxed);
+}
+
+// Iterative, so dropping the last version of a long chain can't
+// blow the stack. Stops at the first node some other version still uses.
+void PersistentIntList::release(PersistentNode* n) {
+    while (n && n->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+        PersistentNode* next = n->next;
+        delete n;
+        n = next;
+    }
+}
+
+bool PersistentIntList::empty() const {
+    return head == nullptr;
+}
+
+int PersistentIntList::front() const {
+    if (empty()) return -1; // actually, UB
+    return head->elem;
+}
+
+int PersistentIntList::size() const {
+    return head ? head->length : 0;
+}
+
+// Sums in long long, as IntLinkedList does: sum() wraps past INT_MAX
+// without signed-overflow UB, average() doesn't wrap at all.
+long long PersistentIntList::total() const {
+    long long sum = 0;
+    for (PersistentNode* h = head; h != nullptr; h = h->next) {
+        sum = sum + h->elem;
+    }
+    return sum;
+}
+
+int PersistentIntList::sum() const {
+    return int(total());
+}
+
+double PersistentIntList::average() const {
+    return double(total()) / size();
+}
+
+void PersistentIntList::print() const {
+    if (empty()) {
+        cout << "List is Empty!" << endl;
+        return;
+    }
+    for (PersistentNode* h = head; h != nullptr; h = h->next) {
+        cout << h->elem << " ";
+    }
+}
+
+void PersistentIntList::addFront(int i) {
+    // The new node takes over this handle's reference to the old head.
+    PersistentNode* n = new PersistentNode();
+    n->elem = i;
+    n->length = size() + 1;
+    n->next = head;
+    head = n;
+}
+
+void PersistentIntList::removeFront() {
+    if (empty()) return;
+    PersistentNode* old = head;
+    head = old->next;
+    retain(head);
+    release(old);
+}
+
+PersistentIntList PersistentIntList::snapshot() const {
+    retain(head);
+    return PersistentIntList(head);
+}
+
+bool PersistentIntList::sharesWith(const PersistentIntList& other) const {
+    return head == other.head;
+}
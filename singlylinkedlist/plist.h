@@ -0,0 +1,53 @@
+#pragma once
+#include <atomic>
+
+class IntLinkedList;
+
+// Node of a persistent list. Nodes are immutable once linked and may be
+// shared by many versions, so they carry their own reference count.
+class PersistentNode {
+private:
+    int elem;
+    int length; // nodes from here to the end, so size() is O(1)
+    std::atomic<int> refs {1};
+    PersistentNode* next {nullptr};
+    friend class PersistentIntList;
+};
+
+// Persistent (immutable, structurally shared) singly linked list.
+// addFront/removeFront build a new version of this handle in O(1) and
+// leave every older snapshot untouched; the tails are shared, not copied.
+// A node is freed when the last version that reaches it goes away.
+class PersistentIntList {
+private:
+    PersistentNode* head;
+    explicit PersistentIntList(PersistentNode* h);
+
+    static void retain(PersistentNode* n);
+    static void release(PersistentNode* n);
+    long long total() const;
+
+public:
+    PersistentIntList();
+    explicit PersistentIntList(IntLinkedList& list); // one O(n) copy
+    PersistentIntList(const PersistentIntList& other);
+    PersistentIntList(PersistentIntList&& other) noexcept;
+    PersistentIntList& operator=(const PersistentIntList& other);
+    PersistentIntList& operator=(PersistentIntList&& other) noexcept;
+    ~PersistentIntList();
+
+    bool empty() const;
+    int front() const;
+    int size() const;
+    int sum() const;
+    double average() const;
+    void print() const;
+
+    void addFront(int i);
+    void removeFront();
+
+    // O(1): the snapshot keeps seeing this version whatever happens next.
+    PersistentIntList snapshot() const;
+    // True when both versions point at the same chain.
+    bool sharesWith(const PersistentIntList& other) const;
+};
@@ -0,0 +1,164 @@
+#include <iostream>
+#include "rlelist.h"
+#include "ldlist.h"
+#include "../common/valueset.h"
+using namespace std;
+
+
+
+RunLengthIntList::RunLengthIntList(): RunLengthIntList(NodeStorage::Heap) {}
+
+RunLengthIntList::RunLengthIntList(NodeStorage storage)
+    : head(nullptr), tail(nullptr), count(0), runCount(0), nodes(storage) {}
+
+RunLengthIntList::RunLengthIntList(IntLinkedList& list): RunLengthIntList() {
+    for (IntNode* h = list.head; h != nullptr; h = h->next) {
+        addBack(h->elem);
+    }
+}
+
+RunLengthIntList::~RunLengthIntList() {
+    nodes.dropChain(head);
+}
+
+bool RunLengthIntList::empty() const {
+    return head == nullptr;
+}
+
+int RunLengthIntList::size() const {
+    return count;
+}
+
+int RunLengthIntList::runs() const {
+    return runCount;
+}
+
+int RunLengthIntList::front() const {
+    if (empty()) return -1; // actually, UB
+    return head->elem;
+}
+
+int RunLengthIntList::back() const {
+    if (empty()) return -1; // actually, UB
+    return tail->elem;
+}
+
+// Adds i at one end, extending the end run if it matches.
+void RunLengthIntList::push(int i, bool front) {
+    count++;
+    RunNode* end = front ? head : tail;
+    if (end && end->elem == i) {
+        end->count++;
+        return;
+    }
+    RunNode* run = nodes.create();
+    run->elem = i;
+    run->count = 1;
+    runCount++;
+    if (front) {
+        run->next = head;
+        head = run;
+        if (!tail) tail = run;
+    } else {
+        run->next = nullptr;
+        if (tail) tail->next = run;
+        else head = run;
+        tail = run;
+    }
+}
+
+void RunLengthIntList::addFront(int i) {
+    push(i, true);
+}
+
+void RunLengthIntList::addBack(int i) {
+    push(i, false);
+}
+
+void RunLengthIntList::print() const {
+    if (empty()) {
+        cout << "List is Empty!" << endl;
+        return;
+    }
+    for (RunNode* h = head; h != nullptr; h = h->next) {
+        for (int c = 0; c < h->count; c++) cout << h->elem << " ";
+    }
+}
+
+// In long long, as IntLinkedList sums: one long run can pass INT_MAX on
+// its own. sum() narrows (wraps) at the end, average() doesn't.
+long long RunLengthIntList::total() const {
+    long long sum = 0;
+    for (RunNode* h = head; h != nullptr; h = h->next) {
+        sum = sum + (long long)h->elem * h->count;
+    }
+    return sum;
+}
+
+int RunLengthIntList::sum() const {
+    return int(total());
+}
+
+double RunLengthIntList::average() const {
+    return double(total()) / size();
+}
+
+void RunLengthIntList::reclaim() {
+    nodes.reclaim();
+}
+
+void RunLengthIntList::removeFront() {
+    if (empty()) return;
+    count--;
+    if (--head->count > 0) return;
+    RunNode* tmp = head;
+    head = head->next;
+    if (!head) tail = nullptr;
+    nodes.destroy(tmp);
+    runCount--;
+}
+
+void RunLengthIntList::removeBack() {
+    if (empty()) return;
+    count--;
+    if (--tail->count > 0) return;
+    if (head == tail) {
+        nodes.destroy(head);
+        head = tail = nullptr;
+        runCount--;
+        return;
+    }
+    RunNode* prev = head;
+    while (prev->next != tail) {
+        prev = prev->next;
+    }
+    nodes.destroy(tail);
+    prev->next = nullptr;
+    tail = prev;
+    runCount--;
+}
+
+int RunLengthIntList::removeAll(int x) {
+    if (empty()) return 0;
+    return remove_if([x](int v) { return v == x; });
+}
+
+int RunLengthIntList::removeAllOf(span<const int> values) {
+    if (empty() || values.empty()) return 0;
+    if (values.size() == 1) return removeAll(values[0]);
+    ValueSet filter(values);
+    return remove_if([&filter](int x) { return filter.contains(x); });
+}
+
+void RunLengthIntList::reverse() {
+    RunNode* prev = nullptr;
+    RunNode* current = head;
+    tail = head;
+    while (current) {
+        RunNode* next = current->next;
+        current->next = prev;
+        prev = current;
+        current = next;
+    }
+    head = prev;
+}
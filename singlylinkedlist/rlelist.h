@@ -0,0 +1,87 @@
+#pragma once
+#include <span>
+#include "../common/nodealloc.h"
+
+class IntLinkedList;
+
+// One run: `count` consecutive copies of elem.
+class RunNode {
+private:
+    int elem;
+    int count;
+    RunNode* next;
+    friend class RunLengthIntList;
+    friend class NodeAllocator<RunNode>;
+};
+
+// IntLinkedList for repetitive data: consecutive equal values share one
+// (value, count) node. addFront/addBack grow the end run or start a new
+// one, removals shrink a run before unlinking it, and removeAll drops
+// whole runs, merging the neighbours when they turn out equal. Adjacent
+// runs always differ, so a list of a million 7s is one node, and sum()
+// is one multiply per run.
+class RunLengthIntList {
+private:
+    RunNode* head;
+    RunNode* tail;  // last run, for O(1) addBack
+    int count;      // values, not runs
+    int runCount;
+    NodeAllocator<RunNode> nodes;
+
+    void push(int i, bool front);
+    long long total() const;
+
+public:
+    RunLengthIntList();
+    explicit RunLengthIntList(NodeStorage storage);
+    explicit RunLengthIntList(IntLinkedList& list); // one O(n) pass
+    ~RunLengthIntList();
+
+    bool empty() const;
+    int size() const;  // O(1)
+    int runs() const;  // nodes in use
+    int front() const;
+    int back() const;
+    void addFront(int i);
+    void addBack(int i);
+    void print() const;
+    int sum() const;
+    double average() const;
+    // Frees nodes parked by the Deferred/Background storage modes.
+    void reclaim();
+
+    // O(1) unless the back run is a single value: then, as in
+    // IntLinkedList, a walk (over runs) finds the new tail.
+    void removeFront();
+    void removeBack();
+    // All return the number of values removed. pred sees each run once.
+    int removeAll(int x);
+    int removeAllOf(std::span<const int> values);
+    template <typename Pred> int remove_if(Pred pred);
+    void reverse();
+};
+
+template <typename Pred>
+int RunLengthIntList::remove_if(Pred pred) {
+    int removed = 0;
+    RunNode* last = nullptr; // last run kept
+    RunNode** link = &head;
+    while (RunNode* run = *link) {
+        if (pred(run->elem)) {
+            removed += run->count;
+        } else if (!last || last->elem != run->elem) {
+            last = run;
+            link = &run->next;
+            continue;
+        } else {
+            // What lay between two equal runs is gone: merge them
+            last->count += run->count;
+        }
+        *link = run->next;
+        nodes.destroy(run);
+        runCount--;
+    }
+    tail = last;
+    count -= removed;
+    return removed;
+}
@@ -1,18 +1,24 @@
 #include <iostream>
 #include "ldlist.h"
+#include "../common/valueset.h"
 using namespace std;
 
+
 void IntLinkedList::removeFront() {
     if (empty()) return;
+    touch();
     IntNode* tmp = head;
     head = head->next;
-    delete tmp;
+    unlinked(tmp, &head);
+    nodes.destroy(tmp);
 }
 
 void IntLinkedList::removeBack() {
     if (empty()) return;
+    touch();
     if (head->next == nullptr) {
-        delete head;
+        unlinked(head, &head);
+        nodes.destroy(head);
         head = nullptr;
         return;
     }
@@ -24,19 +30,22 @@ void IntLinkedList::removeBack() {
         target = target->next;
     }
 
-    delete target;
+    unlinked(target, &prev->next);
+    nodes.destroy(target);
     prev->next = nullptr;
 }
 
 int IntLinkedList::removeAll(int x) {
     if (empty()) return 0;
+    resetCursors();
+    touch();
     int count = 0;
 
     // Remove x's at front
     while (head && head->elem == x) {
         IntNode* tmp = head;
         head = head->next;
-        delete tmp;
+        nodes.destroy(tmp);
         count++;
     }
 
@@ -54,7 +63,7 @@ int IntLinkedList::removeAll(int x) {
     while (mover) {
         if (mover->elem == x) {
             prev->next = mover->next;
-            delete mover;
+            nodes.destroy(mover);
             mover = prev->next;
             count++;
             continue;
@@ -65,8 +74,53 @@ int IntLinkedList::removeAll(int x) {
     return count;
 }
 
+bool IntLinkedList::removeAllStep(int x, int budget, int& removed) {
+    if (!removeLink || x != removeValue) {
+        removeLink = &head;
+        removeValue = x;
+    }
+    while (*removeLink && budget > 0) {
+        IntNode* node = *removeLink;
+        if (node->elem == x) {
+            touch();
+            *removeLink = node->next;
+            unlinked(node, removeLink);
+            nodes.destroy(node);
+            removed++;
+        } else {
+            removeLink = &node->next;
+        }
+        budget--;
+    }
+    if (*removeLink) return false;
+    removeLink = nullptr;
+    return true;
+}
+
+bool IntLinkedList::clearStep(int budget) {
+    if (empty()) return true;
+    touch();
+    while (head && budget > 0) {
+        IntNode* tmp = head;
+        head = head->next;
+        unlinked(tmp, &head);
+        nodes.destroy(tmp);
+        budget--;
+    }
+    return empty();
+}
+
+int IntLinkedList::removeAllOf(span<const int> values) {
+    if (empty() || values.empty()) return 0;
+    if (values.size() == 1) return removeAll(values[0]);
+    ValueSet filter(values);
+    return remove_if([&filter](int x) { return filter.contains(x); });
+}
+
 void IntLinkedList::reverse() {
     if (empty() || head->next == nullptr) return;
+    resetCursors();
+    touch();
 
     IntNode* prev = head;
     IntNode* current = head->next;
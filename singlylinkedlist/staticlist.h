@@ -0,0 +1,164 @@
+#pragma once
+#include <array>
+#include <stdexcept>
+
+// Fixed-capacity singly linked list that works in constant expressions,
+// for tables known at build time:
+//
+//   constexpr auto routes = staticList({10, 20, 30});   // built by the compiler
+//   static_assert(routes.sum() == 60);
+//
+// Same operations as IntLinkedList, but nodes are slots of an array
+// linked by index, so there is no heap and a constexpr object can sit
+// in read-only data. Going over N throws, which at compile time is a
+// build error.
+template <int N>
+class StaticIntList {
+private:
+    struct Slot {
+        int elem {0};
+        int next {-1};
+    };
+
+    std::array<Slot, N> slots {};
+    int head {-1};
+    int tail {-1};
+    int freeSlot {0}; // unused slots, chained through next
+    int count {0};
+
+    constexpr int take() {
+        if (freeSlot < 0) throw std::length_error("StaticIntList is full");
+        int s = freeSlot;
+        freeSlot = slots[s].next;
+        return s;
+    }
+
+    constexpr void give(int s) {
+        slots[s].next = freeSlot;
+        freeSlot = s;
+    }
+
+public:
+    constexpr StaticIntList() {
+        for (int i = 0; i < N; i++) slots[i].next = i + 1 < N ? i + 1 : -1;
+        if (N == 0) freeSlot = -1;
+    }
+
+    static constexpr int capacity() { return N; }
+    constexpr bool empty() const { return head < 0; }
+    constexpr int size() const { return count; }
+
+    constexpr int front() const {
+        if (empty()) return -1; // actually, UB
+        return slots[head].elem;
+    }
+
+    constexpr bool contains(int x) const {
+        for (int s = head; s >= 0; s = slots[s].next) {
+            if (slots[s].elem == x) return true;
+        }
+        return false;
+    }
+
+    constexpr int sum() const {
+        int sum = 0;
+        for (int s = head; s >= 0; s = slots[s].next) sum += slots[s].elem;
+        return sum;
+    }
+
+    constexpr double average() const {
+        return double(sum()) / size();
+    }
+
+    constexpr void addFront(int i) {
+        int s = take();
+        slots[s].elem = i;
+        slots[s].next = head;
+        head = s;
+        if (tail < 0) tail = s;
+        count++;
+    }
+
+    // O(1): unlike IntLinkedList this one keeps the tail.
+    constexpr void addBack(int i) {
+        int s = take();
+        slots[s].elem = i;
+        slots[s].next = -1;
+        if (tail < 0) head = s;
+        else slots[tail].next = s;
+        tail = s;
+        count++;
+    }
+
+    constexpr void removeFront() {
+        if (empty()) return;
+        int s = head;
+        head = slots[s].next;
+        if (head < 0) tail = -1;
+        give(s);
+        count--;
+    }
+
+    constexpr void removeBack() {
+        if (empty()) return;
+        if (head == tail) {
+            removeFront();
+            return;
+        }
+        int prev = head;
+        while (slots[prev].next != tail) prev = slots[prev].next;
+        give(tail);
+        slots[prev].next = -1;
+        tail = prev;
+        count--;
+    }
+
+    // Returns the number of nodes removed.
+    constexpr int removeAll(int x) {
+        int removed = 0;
+        int prev = -1;
+        int s = head;
+        while (s >= 0) {
+            int next = slots[s].next;
+            if (slots[s].elem == x) {
+                if (prev < 0) head = next;
+                else slots[prev].next = next;
+                give(s);
+                removed++;
+            } else {
+                prev = s;
+            }
+            s = next;
+        }
+        tail = prev;
+        count -= removed;
+        return removed;
+    }
+
+    constexpr void reverse() {
+        int prev = -1;
+        int s = head;
+        tail = head;
+        while (s >= 0) {
+            int next = slots[s].next;
+            slots[s].next = prev;
+            prev = s;
+            s = next;
+        }
+        head = prev;
+    }
+
+    // Calls visit(value) front to back.
+    template <typename F>
+    constexpr void forEach(F visit) const {
+        for (int s = head; s >= 0; s = slots[s].next) visit(slots[s].elem);
+    }
+};
+
+// A list holding exactly `values`, in order, with no spare capacity.
+template <int N>
+constexpr StaticIntList<N> staticList(const int (&values)[N]) {
+    StaticIntList<N> list;
+    for (int v : values) list.addBack(v);
+    return list;
+}
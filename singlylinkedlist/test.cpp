@@ -1,9 +1,36 @@
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <sstream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
 #include "ldlist.h"
+#include "plist.h"
+#include "merge.h"
+#include "staticlist.h"
+#include "rlelist.h"
+#include "islist.h"
+#include "../common/benchrunner.h"
+#include <random>
+#include <vector>
+#include <algorithm>
 using namespace std;
 
+// Counts heap allocations, so tests can check that a list made none.
+atomic<long long> allocations {0};
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete" // malloc'd above
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+#pragma GCC diagnostic pop
+
 class TestRunner {
 private:
     int passed = 0;
@@ -20,6 +47,10 @@ public:
         }
     }
     
+    int failures() const {
+        return failed;
+    }
+
     void summary() {
         cout << "\n=== Test Summary ===" << endl;
         cout << "Passed: " << passed << endl;
@@ -29,7 +60,8 @@ public:
 };
 
 // Helper to capture print output
-string captureOutput(IntLinkedList& list) {
+template <typename List>
+string captureOutput(List& list) {
     stringstream buffer;
     streambuf* old = cout.rdbuf(buffer.rdbuf());
     list.print();
@@ -454,6 +486,814 @@ void testMemoryStress(TestRunner& t) {
     t.test("Mass removeAll empties list", mass.empty());
 }
 
+void testPersistent(TestRunner& t) {
+    cout << "\n--- Persistent List Tests ---" << endl;
+
+    PersistentIntList empty;
+    t.test("Persistent list starts empty", empty.empty() && empty.size() == 0);
+    empty.removeFront();
+    t.test("Persistent removeFront on empty doesn't crash", empty.empty());
+
+    PersistentIntList v1;
+    v1.addFront(3);
+    v1.addFront(2);
+    v1.addFront(1); // 1->2->3
+    PersistentIntList snap = v1.snapshot();
+    t.test("Snapshot shares the chain", snap.sharesWith(v1));
+
+    v1.addFront(0);
+    v1.removeFront();
+    v1.removeFront(); // 2->3
+    t.test("Writer sees its own version", v1.size() == 2 && v1.sum() == 5);
+    t.test("Snapshot unaffected by later writes", snap.size() == 3 && snap.sum() == 6);
+    t.test("Snapshot front unchanged", snap.front() == 1);
+
+    // Branch off the snapshot: both versions share the 2->3 tail
+    PersistentIntList branch = snap.snapshot();
+    branch.removeFront();
+    branch.addFront(10); // 10->2->3
+    t.test("Branch has its own head", branch.front() == 10 && branch.sum() == 15);
+    t.test("Original snapshot still intact", snap.sum() == 6);
+
+    // Old versions are reclaimed when the last handle goes away
+    {
+        PersistentIntList scoped = branch;
+        scoped.addFront(7);
+    }
+    t.test("Dropping a version keeps the shared tail alive", branch.size() == 3);
+
+    IntLinkedList source;
+    source.addBack(4);
+    source.addBack(5);
+    source.addBack(6);
+    PersistentIntList fromList(source);
+    t.test("Built from IntLinkedList keeps order", fromList.front() == 4 && fromList.size() == 3);
+    t.test("Built from IntLinkedList average", fromList.average() == 5.0);
+
+    PersistentIntList large;
+    large.addFront(2147483647);
+    large.addFront(2147483646);
+    large.addFront(2147483645);
+    t.test("Persistent average with large numbers", large.average() == 2147483646.0);
+
+    PersistentIntList big;
+    for (int i = 0; i < 100000; i++) {
+        big.addFront(i % 10);
+    }
+    PersistentIntList bigSnap = big.snapshot();
+    while (!big.empty()) big.removeFront();
+    t.test("Snapshot of large list survives writer draining it", bigSnap.size() == 100000);
+}
+
+void testRemoveAllOf(TestRunner& t) {
+    cout << "\n--- RemoveAllOf / remove_if / partition Tests ---" << endl;
+
+    IntLinkedList empty;
+    int targets[] = {1, 2, 3};
+    t.test("removeAllOf on empty list returns 0", empty.removeAllOf(targets) == 0);
+
+    // Same as the mass removeAll loop in testMemoryStress, in one pass
+    IntLinkedList mass;
+    for (int i = 0; i < 500; i++) {
+        mass.addBack(i % 10);
+    }
+    int digits[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+    t.test("removeAllOf counts every removed node", mass.removeAllOf(digits) == 500);
+    t.test("removeAllOf empties list", mass.empty());
+
+    IntLinkedList mixed;
+    for (int i = 0; i < 20; i++) {
+        mixed.addBack(i);
+    }
+    int some[] = {0, 5, 19, 42};
+    int removed = mixed.removeAllOf(some);
+    t.test("removeAllOf ignores values not in the list", removed == 3);
+    t.test("removeAllOf leaves the rest", mixed.size() == 17 && mixed.sum() == 190 - 24);
+
+    // Far-apart values go through the hash filter instead of the bitset
+    IntLinkedList wide;
+    wide.addBack(-2147483647 - 1);
+    wide.addBack(7);
+    wide.addBack(2147483647);
+    wide.addBack(1000000);
+    int extremes[] = {2147483647, -2147483647 - 1, 1000000};
+    t.test("removeAllOf with wide value range", wide.removeAllOf(extremes) == 3 && wide.sum() == 7);
+
+    IntLinkedList evens;
+    for (int i = 1; i <= 10; i++) {
+        evens.addBack(i);
+    }
+    removed = evens.remove_if([](int x) { return x % 2 == 0; });
+    t.test("remove_if returns removal count", removed == 5);
+    t.test("remove_if keeps the others", evens.size() == 5 && evens.sum() == 25);
+
+    IntLinkedList source;
+    for (int i = 1; i <= 6; i++) {
+        source.addBack(i);
+    }
+    IntLinkedList odds;
+    odds.addBack(100);
+    int moved = source.stable_partition([](int x) { return x % 2 == 0; }, odds);
+    t.test("stable_partition returns moved count", moved == 3);
+    t.test("stable_partition keeps matches", source.size() == 3 && source.sum() == 12);
+    t.test("stable_partition appends in order", odds.size() == 4 && captureOutput(odds) == "100 1 3 5 ");
+
+    IntLinkedList unstable;
+    for (int i = 1; i <= 6; i++) {
+        unstable.addBack(i);
+    }
+    IntLinkedList rest;
+    moved = unstable.partition([](int x) { return x > 3; }, rest);
+    t.test("partition returns moved count", moved == 3);
+    t.test("partition relinks into rest", rest.size() == 3 && rest.sum() == 6 && unstable.sum() == 15);
+    t.test("partition into itself is a no-op", unstable.partition([](int) { return false; }, unstable) == 0);
+}
+
+void testStorageModes(TestRunner& t) {
+    cout << "\n--- Storage Mode Tests ---" << endl;
+
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Deferred,
+                           NodeStorage::Background, NodeStorage::Pool, NodeStorage::ThreadCache};
+    string names[] = {"Heap", "Deferred", "Background", "Pool", "ThreadCache"};
+
+    for (int m = 0; m < 5; m++) {
+        IntLinkedList list(modes[m]);
+        for (int i = 0; i < 10000; i++) {
+            list.addBack(i % 10);
+        }
+        int removed = list.removeAll(3);
+        list.removeFront();
+        list.removeBack();
+        list.addFront(100);
+        t.test(names[m] + ": removeAll count", removed == 1000);
+        t.test(names[m] + ": contents after removals", list.size() == 8999 && list.sum() == 42000 - 9 + 100);
+
+        list.reclaim();
+        for (int i = 0; i < 5000; i++) {
+            list.removeFront();
+        }
+        list.addBack(1);
+        t.test(names[m] + ": reuse after many removals", list.size() == 4000);
+        // Destructor frees (or hands off) whatever is left
+    }
+
+    IntLinkedList deferred(NodeStorage::Deferred);
+    deferred.addBack(1);
+    deferred.addBack(2);
+    deferred.removeAll(1);
+    deferred.reclaim();
+    t.test("Deferred list usable after reclaim", deferred.size() == 1 && deferred.sum() == 2);
+
+    Reclaimer::instance().drain();
+    t.test("Background frees drain", true);
+}
+
+// Scrambles node order in memory by relinking, like a long mixed workload
+void scramble(IntLinkedList& list, int rounds) {
+    unsigned seed = 12345;
+    IntLinkedList rest;
+    for (int r = 0; r < rounds; r++) {
+        list.partition([&seed](int) { seed = seed * 1103515245 + 12345; return (seed >> 16) & 1; }, rest);
+        rest.partition([](int) { return false; }, list);
+    }
+}
+
+void testCompact(TestRunner& t) {
+    cout << "\n--- Compaction Tests ---" << endl;
+
+    IntLinkedList empty;
+    empty.compact();
+    t.test("compact on empty list", empty.empty() && empty.fragmentation() == 0.0);
+
+    IntLinkedList list;
+    for (int i = 0; i < 5000; i++) {
+        list.addFront(i);
+    }
+    scramble(list, 8);
+    int sumBefore = list.sum();
+    string before = captureOutput(list);
+    t.test("Scrambled list is fragmented", list.fragmentation() > 0.5);
+
+    list.compact();
+    t.test("compact keeps order and contents", captureOutput(list) == before && list.sum() == sumBefore);
+    t.test("compact makes the list contiguous", list.fragmentation() == 0.0);
+
+    list.removeAll(17);
+    list.addBack(-1);
+    list.removeFront();
+    t.test("Compacted list still mutable", list.size() == 4999);
+
+    // Incremental, with mutations between steps
+    IntLinkedList inc(NodeStorage::Deferred);
+    for (int i = 0; i < 3000; i++) {
+        inc.addFront(i % 50);
+    }
+    scramble(inc, 6);
+    int steps = 0;
+    int expectedSize = 3000;
+    while (!inc.compactStep(100)) {
+        steps++;
+        if (steps % 3 == 0) {
+            inc.addFront(7);
+            expectedSize++;
+        }
+        if (steps == 10) expectedSize -= inc.removeAll(3);
+        if (steps == 12) {
+            inc.removeBack();
+            expectedSize--;
+        }
+    }
+    t.test("compactStep takes several bounded steps", steps >= 29);
+    t.test("compactStep keeps contents under mutation", inc.size() == expectedSize);
+    t.test("compactStep leaves list mostly contiguous", inc.fragmentation() < 0.05);
+
+    // Compacting a pooled list again restores order after churn
+    IntLinkedList pooled(NodeStorage::Pool);
+    for (int i = 0; i < 2000; i++) {
+        pooled.addFront(i);
+    }
+    scramble(pooled, 6);
+    pooled.compact();
+    t.test("Recompacting a pooled list", pooled.fragmentation() == 0.0 && pooled.size() == 2000);
+
+    // Destroyed half way through an incremental compaction
+    {
+        IntLinkedList partial;
+        for (int i = 0; i < 1000; i++) {
+            partial.addFront(i);
+        }
+        partial.compactStep(400);
+    }
+    t.test("Destroying a list mid-compaction", true);
+
+    // Pooled nodes are copied, not relinked, across lists
+    IntLinkedList heapSide;
+    {
+        IntLinkedList poolSide(NodeStorage::Pool);
+        for (int i = 0; i < 100; i++) {
+            poolSide.addBack(i);
+        }
+        poolSide.stable_partition([](int x) { return x < 50; }, heapSide);
+        poolSide.partition([](int x) { return x < 10; }, heapSide);
+        heapSide.partition([](int x) { return x < 75; }, poolSide);
+    }
+    t.test("Partition between pooled and heap lists", heapSide.size() == 65);
+}
+
+IntLinkedList* sortedList(const vector<int>& values, NodeStorage storage = NodeStorage::Heap) {
+    IntLinkedList* list = new IntLinkedList(storage);
+    for (int i = int(values.size()) - 1; i >= 0; i--) {
+        list->addFront(values[i]);
+    }
+    return list;
+}
+
+string joined(const vector<int>& values) {
+    string s;
+    for (int v : values) s += to_string(v) + " ";
+    return s;
+}
+
+void testMerge(TestRunner& t) {
+    cout << "\n--- Merge and Set Operation Tests ---" << endl;
+
+    // k-way merge of random sorted lists, mixing storage modes
+    mt19937 rng(11);
+    NodeStorage modes[] = {NodeStorage::Heap, NodeStorage::Pool, NodeStorage::Deferred, NodeStorage::ThreadCache};
+    for (int k : {1, 2, 3, 7, 64}) {
+        vector<IntLinkedList*> lists;
+        vector<int> all;
+        for (int i = 0; i < k; i++) {
+            vector<int> values(rng() % 40);
+            for (int& v : values) v = int(rng() % 100) - 50;
+            sort(values.begin(), values.end());
+            all.insert(all.end(), values.begin(), values.end());
+            lists.push_back(sortedList(values, modes[i % 4]));
+        }
+        sort(all.begin(), all.end());
+
+        IntLinkedList out;
+        ListMerge::merge(lists, out);
+        bool drained = all_of(lists.begin(), lists.end(), [](IntLinkedList* l) { return l->empty(); });
+        t.test("merge of " + to_string(k) + " lists is sorted and complete",
+               captureOutput(out) == joined(all) && drained);
+        for (IntLinkedList* l : lists) delete l;
+    }
+
+    vector<IntLinkedList*> lists;
+    vector<int> all;
+    for (int i = 0; i < 37; i++) {
+        vector<int> values;
+        for (int v = i; v < 300; v += 1 + i % 5) values.push_back(v);
+        all.insert(all.end(), values.begin(), values.end());
+        lists.push_back(sortedList(values, modes[i % 4]));
+    }
+    sort(all.begin(), all.end());
+    IntLinkedList* out = sortedList({-5, 1000});
+    all.insert(all.begin(), -5);
+    all.push_back(1000);
+    ListMerge::mergeParallel(lists, *out, 4);
+    t.test("mergeParallel includes out's own nodes", captureOutput(*out) == joined(all));
+    delete out;
+    for (IntLinkedList* l : lists) delete l;
+
+    IntLinkedList* a = sortedList({1, 2, 2, 4, 7});
+    IntLinkedList* b = sortedList({2, 3, 3, 7, 9}, NodeStorage::Pool);
+    ListMerge::merge(*a, *b);
+    t.test("Two-list merge", captureOutput(*a) == "1 2 2 2 3 3 4 7 7 9 " && b->empty());
+    delete a;
+    delete b;
+
+    // Set operations go by value, with a's duplicates kept
+    a = sortedList({1, 2, 2, 4, 7, 7});
+    b = sortedList({2, 3, 3, 7, 9});
+    int added = ListMerge::unite(*a, *b);
+    t.test("unite adds values only in b", captureOutput(*a) == "1 2 2 3 3 4 7 7 9 " && added == 3);
+    t.test("unite empties b", b->empty());
+    delete a;
+    delete b;
+
+    a = sortedList({1, 2, 2, 4, 7, 7});
+    b = sortedList({2, 3, 7, 7, 9});
+    int removed = ListMerge::intersect(*a, *b);
+    t.test("intersect keeps shared values", captureOutput(*a) == "2 2 7 7 " && removed == 2);
+    t.test("intersect leaves b alone", b->size() == 5);
+    delete a;
+
+    a = sortedList({1, 2, 2, 4, 7, 7}, NodeStorage::Pool);
+    removed = ListMerge::subtract(*a, *b);
+    t.test("subtract removes every occurrence", captureOutput(*a) == "1 4 " && removed == 4);
+    removed = ListMerge::subtract(*a, *a);
+    t.test("subtract from itself empties", a->empty() && removed == 2);
+    delete a;
+    delete b;
+}
+
+// Plain node for building broken chains by hand
+struct LooseNode {
+    int elem;
+    LooseNode* next;
+};
+
+void testAnalysis(TestRunner& t) {
+    cout << "\n--- Chain Analysis Tests ---" << endl;
+
+    // tail of mu nodes, then a loop of lambda nodes
+    bool allFound = true;
+    for (int mu : {0, 1, 5, 255, 256, 700}) {
+        for (int lambda : {1, 2, 3, 256, 1000}) {
+            vector<LooseNode> chain(mu + lambda);
+            for (int i = 0; i < mu + lambda; i++) {
+                chain[i].elem = i;
+                chain[i].next = &chain[(i + 1 < mu + lambda) ? i + 1 : mu];
+            }
+            ChainAnalysis<LooseNode> a;
+            a.run(&chain[0]);
+            const ChainShape& s = a.shape();
+            bool ok = s.cyclic && s.cycleStart == mu && s.cycleLength == lambda && s.nodes == mu + lambda;
+            for (int p : {0, mu, mu + lambda - 1, (mu + lambda) / 2}) {
+                ok = ok && a.at(p) == &chain[p];
+            }
+            ok = ok && a.at(mu + lambda) == nullptr;
+            allFound = allFound && ok;
+        }
+    }
+    t.test("Cycle start, length and positions found", allFound);
+
+    vector<LooseNode> line(1000);
+    for (int i = 0; i < 1000; i++) line[i] = {i, i + 1 < 1000 ? &line[i + 1] : nullptr};
+    ChainAnalysis<LooseNode> a;
+    a.run(&line[0]);
+    t.test("Acyclic chain measured", !a.shape().cyclic && a.shape().nodes == 1000 && a.shape().cycleStart == -1);
+    t.test("Any position reachable", a.at(0) == &line[0] && a.at(517) == &line[517] && a.at(999) == &line[999]);
+    a.run(nullptr);
+    t.test("Empty chain", a.shape().nodes == 0 && !a.shape().cyclic && a.at(0) == nullptr);
+
+    IntLinkedList list;
+    t.test("Empty list: no middle", list.middle() == -1 && list.kthFromEnd(1) == -1);
+    for (int i = 0; i < 1001; i++) list.addBack(i);
+    t.test("List has no cycle", !list.hasCycle() && list.shape().nodes == 1001);
+    t.test("Middle of odd length", list.middle() == 500);
+    t.test("kthFromEnd", list.kthFromEnd(1) == 1000 && list.kthFromEnd(1001) == 0 && list.kthFromEnd(300) == 701);
+    t.test("kthFromEnd out of range", list.kthFromEnd(0) == -1 && list.kthFromEnd(1002) == -1);
+
+    // Every kind of change has to invalidate the cache
+    list.removeBack();
+    t.test("removeBack invalidates", list.size() == 1000 && list.kthFromEnd(1) == 999 && list.middle() == 500);
+    list.addFront(-1);
+    t.test("addFront invalidates", list.middle() == 499 && list.size() == 1001);
+    list.reverse();
+    t.test("reverse invalidates", list.kthFromEnd(2) == 0 && list.middle() == 499);
+    list.removeAll(500);
+    t.test("removeAll invalidates", list.shape().nodes == 1000 && list.middle() == 498);
+    list.compact();
+    t.test("compact invalidates", list.middle() == 498 && list.kthFromEnd(2) == 0);
+    IntLinkedList rest;
+    list.stable_partition([](int x) { return x < 100; }, rest);
+    t.test("partition invalidates both", list.size() == 101 && rest.middle() == 550);
+
+    // shape() and hasCycle() straight after each change: the cached
+    // shape has to be redone, not handed back from before
+    IntLinkedList tracked;
+    const ChainShape& seen = tracked.shape();
+    t.test("Empty list shape", seen.nodes == 0 && !tracked.hasCycle());
+    for (int i = 0; i < 10; i++) tracked.addBack(i % 4);
+    t.test("Shape after addBack", tracked.shape().nodes == 10 && !tracked.hasCycle());
+    long long passes = tracked.analysisPasses();
+    tracked.shape();
+    tracked.hasCycle();
+    tracked.middle();
+    tracked.kthFromEnd(3);
+    tracked.size();
+    t.test("Cached shape is reused until a change", tracked.analysisPasses() == passes && seen.nodes == 10);
+    tracked.addBack(9);
+    tracked.removeBack();
+    t.test("A change forces one new walk", tracked.shape().nodes == 10 && !tracked.hasCycle() &&
+                                           tracked.analysisPasses() == passes + 1);
+    tracked.addFront(7);
+    t.test("Shape after addFront", tracked.shape().nodes == 11 && tracked.middle() == 0);
+    tracked.removeFront();
+    tracked.removeBack();
+    t.test("Shape after removeFront/removeBack", tracked.shape().nodes == 9 && !tracked.hasCycle());
+    tracked.reverse();
+    t.test("Shape after reverse", tracked.shape().nodes == 9 && tracked.kthFromEnd(1) == 0);
+    t.test("Shape after removeAll", tracked.removeAll(0) == 3 && tracked.shape().nodes == 6);
+    tracked.remove_if([](int x) { return x == 1; });
+    t.test("Shape after remove_if", tracked.shape().nodes == 4 && !tracked.hasCycle());
+    int removed = 0;
+    while (!tracked.removeAllStep(2, 1, removed)) {}
+    t.test("Shape after removeAllStep", removed == 2 && tracked.shape().nodes == 2);
+    IntLinkedList other;
+    other.addBack(5);
+    ListMerge::merge(tracked, other);
+    t.test("Shape after merge", tracked.shape().nodes == 3 && other.shape().nodes == 0);
+    tracked.thaw(tracked.freeze());
+    t.test("Shape after freeze/thaw", tracked.shape().nodes == 3 && !tracked.hasCycle());
+    while (!tracked.clearStep(1)) {}
+    t.test("Shape after clearStep", tracked.shape().nodes == 0 && !tracked.hasCycle() && tracked.middle() == -1);
+}
+
+// Built and transformed entirely by the compiler; the static_asserts
+// only compile if every operation was evaluated at compile time.
+constexpr StaticIntList<16> routingTable() {
+    StaticIntList<16> table;
+    for (int i = 1; i <= 10; i++) table.addBack(i * 10);
+    table.addFront(5);
+    table.removeAll(50);
+    table.removeBack();   // drops 100
+    table.removeFront();  // drops 5
+    table.reverse();
+    return table;
+}
+
+constexpr auto routes = routingTable();
+constexpr auto whitelist = staticList({443, 80, 8080, 80});
+constinit StaticIntList<4> startupFree = staticList({1, 2, 3, 4});
+
+static_assert(routes.size() == 8);
+static_assert(routes.front() == 90);
+static_assert(routes.sum() == 10 + 20 + 30 + 40 + 60 + 70 + 80 + 90);
+static_assert(routes.average() == 50.0);
+static_assert(!routes.contains(50) && routes.contains(60));
+static_assert(whitelist.size() == 4 && whitelist.capacity() == 4);
+static_assert([] {
+    auto w = whitelist;
+    int removed = w.removeAll(80);
+    w.addFront(22); // reuses a freed slot
+    return removed == 2 && w.size() == 3 && w.front() == 22 && w.sum() == 22 + 443 + 8080;
+}());
+static_assert([] {
+    StaticIntList<3> l;
+    l.removeFront();
+    l.removeBack();
+    return l.empty() && l.sum() == 0 && l.removeAll(1) == 0;
+}());
+
+void testStaticList(TestRunner& t) {
+    cout << "\n--- StaticIntList Tests ---" << endl;
+
+    string order;
+    routes.forEach([&order](int v) { order += to_string(v) + " "; });
+    t.test("Compile-time table in order", order == "90 80 70 60 40 30 20 10 ");
+    t.test("constinit table needs no startup code", startupFree.sum() == 10);
+
+    // The same code runs at run time too
+    StaticIntList<4> l;
+    l.addBack(1);
+    l.addBack(2);
+    l.addBack(1);
+    l.removeAll(1);
+    l.addBack(3);
+    l.reverse();
+    t.test("Run-time use matches", l.size() == 2 && l.front() == 3 && l.sum() == 5);
+
+    bool threw = false;
+    try {
+        l.addBack(4);
+        l.addBack(5);
+        l.addBack(6);
+    } catch (const length_error&) {
+        threw = true;
+    }
+    t.test("Overfilling throws", threw && l.size() == 4);
+}
+
+void testInlineNodes(TestRunner& t) {
+    cout << "\n--- Inline Node Tests ---" << endl;
+
+    // Allocation counts are taken before t.test(), whose name strings
+    // allocate too
+    long long before = allocations;
+    bool works;
+    {
+        IntLinkedList list;
+        for (int i = 0; i < listInlineNodes; i++) list.addBack(i);
+        list.removeAll(3);
+        list.reverse();
+        list.addFront(99);
+        list.removeBack();
+        works = list.size() == 15 && list.sum() == 120 - 3 + 99;
+    }
+    long long made = allocations - before;
+    t.test("Short list works", works);
+    t.test("Short list never allocates", made == 0);
+
+    before = allocations;
+    IntLinkedList list;
+    for (int i = 0; i < listInlineNodes + 5; i++) list.addFront(i);
+    made = allocations - before;
+    t.test("Spills past the inline nodes", made == 5);
+
+    list.removeAll(0); // an inline node
+    before = allocations;
+    list.addFront(0);
+    made = allocations - before;
+    t.test("Freed inline slot is reused", made == 0);
+
+    // Mixed inline/heap nodes moving between lists
+    IntLinkedList odd;
+    list.stable_partition([](int x) { return x % 2 == 0; }, odd);
+    t.test("Partition copies inline nodes, relinks heap ones",
+           list.sum() + odd.sum() == 210 && odd.size() == 10 && list.size() == 11);
+    IntLinkedList merged;
+    IntLinkedList a, b;
+    for (int i = 10; i > 0; i -= 2) a.addFront(i);
+    for (int i = 9; i > 0; i -= 2) b.addFront(i);
+    IntLinkedList* both[] = {&a, &b};
+    ListMerge::merge(both, merged);
+    t.test("Merge of short lists", captureOutput(merged) == "1 2 3 4 5 6 7 8 9 10 " && a.empty() && b.empty());
+}
+
+void testRunLength(TestRunner& t) {
+    cout << "\n--- Run-Length Encoded List Tests ---" << endl;
+
+    // Same fixtures as testRemoveAllExtreme
+    RunLengthIntList identical;
+    for (int i = 0; i < 100; i++) identical.addBack(7);
+    t.test("RLE identical values are one run", identical.runs() == 1 && identical.size() == 100);
+    t.test("RLE sum multiplies", identical.sum() == 700 && identical.average() == 7.0);
+    RunLengthIntList longRun;
+    for (int i = 0; i < 1000000; i++) longRun.addBack(5000);
+    t.test("RLE long run averages without overflow", longRun.runs() == 1 && longRun.average() == 5000.0);
+    int removed = identical.removeAll(7);
+    t.test("RLE removeAll identical elements", removed == 100 && identical.empty() && identical.size() == 0);
+
+    RunLengthIntList alternating;
+    for (int i = 0; i < 100; i++) alternating.addBack(i % 2);
+    t.test("RLE alternating values, one run each", alternating.runs() == 100);
+    removed = alternating.removeAll(0);
+    t.test("RLE removeAll merges the runs left behind",
+           removed == 50 && alternating.size() == 50 && alternating.runs() == 1 && alternating.sum() == 50);
+
+    // Runs shrink and split off at the ends
+    RunLengthIntList list;
+    for (int v : {1, 1, 2, 2, 2, 3}) list.addBack(v);
+    list.addFront(1);
+    list.addFront(0);
+    t.test("RLE builds runs at both ends", captureOutput(list) == "0 1 1 1 2 2 2 3 " && list.runs() == 4);
+    list.removeFront();
+    list.removeFront();
+    list.removeBack();
+    t.test("RLE removals shrink runs", captureOutput(list) == "1 1 2 2 2 " && list.runs() == 2);
+    list.removeBack();
+    list.addBack(4);
+    t.test("RLE back of a shrunk run", list.back() == 4 && list.runs() == 3 && list.size() == 5);
+    list.removeBack();
+    list.removeBack();
+    list.removeBack();
+    t.test("RLE removeBack walks to the new tail", list.back() == 1 && list.runs() == 1 && list.size() == 2);
+    list.removeBack();
+    list.removeBack();
+    list.removeBack();
+    t.test("RLE removing past empty is harmless", list.empty() && list.runs() == 0);
+    list.addBack(5);
+    t.test("RLE reusable after emptying", list.front() == 5 && list.back() == 5);
+
+    RunLengthIntList mixed;
+    for (int v : {3, 3, 1, 2, 2, 1, 3, 5, 5}) mixed.addBack(v);
+    int values[] = {1, 2};
+    removed = mixed.removeAllOf(values);
+    t.test("RLE removeAllOf merges across several runs",
+           removed == 4 && captureOutput(mixed) == "3 3 3 5 5 " && mixed.runs() == 2);
+    mixed.reverse();
+    mixed.addBack(3);
+    mixed.addFront(5);
+    t.test("RLE reverse keeps both ends right", captureOutput(mixed) == "5 5 5 3 3 3 3 " && mixed.runs() == 2);
+    removed = mixed.remove_if([](int x) { return x > 4; });
+    t.test("RLE remove_if", removed == 3 && mixed.front() == 3 && mixed.back() == 3);
+
+    IntLinkedList plain;
+    for (int i = 0; i < 1000; i++) plain.addFront(i / 100);
+    RunLengthIntList packed(plain);
+    t.test("RLE from an IntLinkedList", packed.size() == 1000 && packed.runs() == 10 && packed.sum() == plain.sum());
+
+    RunLengthIntList pooled(NodeStorage::Pool);
+    for (int i = 0; i < 10000; i++) pooled.addBack(i % 3 == 0 ? i : -1);
+    pooled.removeAll(-1);
+    t.test("RLE pool storage", pooled.size() == 3334 && pooled.runs() == 3334);
+}
+
+void testFreeze(TestRunner& t) {
+    cout << "\n--- Frozen List Tests ---" << endl;
+
+    IntLinkedList list;
+    mt19937 rng(7);
+    vector<int> values;
+    for (int i = 0; i < 1000; i++) {
+        int v = i % 5 == 0 ? int(rng()) : i / 10; // big jumps among small steps
+        values.push_back(v);
+        list.addFront(v);
+    }
+    values.push_back(INT_MIN);
+    values.push_back(INT_MAX);
+    values.push_back(INT_MIN);
+    list.addFront(INT_MIN);
+    list.addFront(INT_MAX);
+    list.addFront(INT_MIN);
+    reverse(values.begin(), values.end());
+    int expectedSum = list.sum();
+    string expectedOutput = captureOutput(list);
+
+    FrozenIntList frozen = list.freeze();
+    t.test("Freeze empties the list", list.empty());
+    vector<int> decoded;
+    frozen.forEach([&decoded](int v) { decoded.push_back(v); });
+    t.test("Frozen values decode in order, extremes included", decoded == values);
+    t.test("Frozen sum and size", frozen.sum() == expectedSum && frozen.size() == 1003);
+    t.test("Frozen print matches the list", captureOutput(frozen) == expectedOutput);
+    t.test("Frozen contains skips by range", frozen.contains(INT_MAX) && frozen.contains(99) && !frozen.contains(100));
+    t.test("Frozen list is smaller than its nodes", frozen.memory() < 1003 * (long long)sizeof(int) * 2);
+
+    list.thaw(frozen);
+    t.test("Thaw restores the list", captureOutput(list) == expectedOutput && list.size() == 1003);
+    list.addBack(5);
+    t.test("Thawed list is mutable", list.size() == 1004 && frozen.size() == 1003);
+
+    // Runs are summed from the block header; palindromes across blocks
+    IntLinkedList runs;
+    for (int i = 0; i < 300; i++) runs.addFront(i < 150 ? 4 : -4);
+    for (int i = 0; i < 300; i++) runs.addFront(i < 150 ? -4 : 4);
+    FrozenIntList frozenRuns = runs.freeze();
+    t.test("Frozen runs sum", frozenRuns.sum() == 0 && frozenRuns.average() == 0.0);
+    FrozenIntList::Builder large;
+    for (int i = 0; i < 3; i++) large.add(2147483645 + i);
+    t.test("Frozen average with large numbers", large.finish().average() == 2147483646.0);
+    t.test("Frozen palindrome across blocks", frozenRuns.isPalindrome());
+    FrozenIntList::Builder odd;
+    for (int i = 0; i < 257; i++) odd.add(i == 200 ? 1 : 0);
+    t.test("Frozen non-palindrome", !odd.finish().isPalindrome());
+
+    FrozenIntList none = runs.freeze();
+    runs.thaw(none);
+    t.test("Freeze and thaw of an empty list", none.empty() && none.isPalindrome() && runs.empty());
+}
+
+void testIncremental(TestRunner& t) {
+    cout << "\n--- Incremental removeAll/clear Tests ---" << endl;
+
+    IntLinkedList list;
+    for (int i = 0; i < 1000; i++) list.addBack(i % 10);
+    int removed = 0;
+    int steps = 1;
+    while (!list.removeAllStep(3, 64, removed)) steps++;
+    t.test("removeAllStep finishes in bounded steps", steps == 16 && removed == 100 && list.size() == 900);
+
+    // Interleaved with other work, some of which restarts the scan
+    IntLinkedList busy;
+    for (int i = 0; i < 1000; i++) busy.addBack(i % 10);
+    removed = 0;
+    int added = 0, dropped = 0;
+    for (int step = 0; !busy.removeAllStep(7, 50, removed); step++) {
+        busy.addBack(7); // ahead of the cursor: removed as well
+        added++;
+        if (step % 5 == 0) {
+            busy.removeFront(); // keeps the cursor's place
+            busy.removeBack();
+            dropped += 2;
+        }
+        if (step == 3) busy.removeAllStep(4, 10, removed); // switches value, restarts
+        if (step == 6) busy.reverse(); // restarts
+    }
+    IntLinkedList sevens;
+    busy.stable_partition([](int x) { return x != 7; }, sevens);
+    t.test("removeAllStep survives interleaved changes", sevens.empty());
+    t.test("removeAllStep count adds up", busy.size() == 1000 + added - dropped - removed);
+
+    IntLinkedList big(NodeStorage::Pool);
+    for (int i = 0; i < 10000; i++) big.addFront(i);
+    int calls = 0;
+    while (!big.clearStep(1000)) {
+        calls++;
+        big.addFront(-1); // still usable in between
+    }
+    t.test("clearStep empties in bounded calls", big.empty() && calls == 10);
+    big.addBack(5);
+    t.test("List reusable after clearStep", big.size() == 1 && big.sum() == 5);
+}
+
+struct Packet : SListHook<> {
+    int bytes;
+};
+
+struct Retry {};
+struct Job : SListHook<>, SListHook<Retry> {
+    int id;
+};
+
+void testIntrusiveList(TestRunner& t) {
+    cout << "\n--- Intrusive List Tests ---" << endl;
+
+    Packet ring[8];
+    for (int i = 0; i < 8; i++) ring[i].bytes = i;
+    IntrusiveSList<Packet> outbox;
+    auto contents = [&outbox] {
+        string s;
+        outbox.forEach([&s](Packet& p) { s += to_string(p.bytes) + " "; });
+        return s;
+    };
+
+    long long before = allocations;
+    for (int i = 3; i < 6; i++) outbox.addBack(ring[i]);
+    outbox.addFront(ring[1]);
+    outbox.insertAfter(ring[1], ring[2]);
+    outbox.addBack(ring[6]);
+    outbox.removeFront();
+    outbox.removeBack();
+    bool removed = outbox.remove(ring[4]);
+    outbox.removeAfter(ring[3]);
+    long long made = allocations - before;
+    t.test("Intrusive list links caller objects", contents() == "2 3 " && outbox.size() == 2 && removed);
+    t.test("Intrusive add/remove never allocate", made == 0);
+    t.test("Unlinked objects know it", !ring[1].linked() && !ring[4].linked() && ring[2].linked());
+    t.test("remove() of an object not on the list", !outbox.remove(ring[7]) && outbox.size() == 2);
+    outbox.addBack(ring[2]); // already linked
+    t.test("Adding a linked object is refused", outbox.size() == 2 && &outbox.back() == &ring[3]);
+
+    for (int i = 4; i < 8; i++) outbox.addBack(ring[i]);
+    outbox.reverse();
+    t.test("Intrusive reverse", contents() == "7 6 5 4 3 2 " && outbox.back().bytes == 2);
+    outbox.addBack(ring[0]);
+    t.test("Tail follows reverse", contents() == "7 6 5 4 3 2 0 ");
+    int odd = outbox.remove_if([](Packet& p) { return p.bytes % 2 == 1; });
+    t.test("Intrusive remove_if", odd == 3 && contents() == "6 4 2 0 " && !ring[5].linked());
+    outbox.clear();
+    t.test("clear() unlinks everything", outbox.empty() && !ring[6].linked() && !ring[0].linked());
+
+    // One object on two lists at once, through tagged hooks
+    Job jobs[4];
+    IntrusiveSList<Job> all;
+    IntrusiveSList<Job, Retry> retry;
+    for (int i = 0; i < 4; i++) {
+        jobs[i].id = i;
+        all.addBack(jobs[i]);
+        if (i % 2) retry.addFront(jobs[i]);
+    }
+    retry.removeFront();
+    t.test("Tagged hooks are independent", all.size() == 4 && retry.size() == 1 && retry.front().id == 1);
+}
+
+void testBenchRunner(TestRunner& t) {
+    cout << "\n--- BenchRunner Tests ---" << endl;
+
+    BenchRunner runner;
+    IntLinkedList list;
+    for (int i = 0; i < 1000; i++) list.addFront(i % 10);
+    int removed = 0;
+    double ms = runner.run("removeAll", [&] { removed = list.removeAll(3); });
+    runner.run("reverse", [&] { list.reverse(); });
+    t.test("Scenarios run once each", removed == 100 && list.size() == 900 && runner.results().size() == 2);
+    const BenchSample& first = runner.results()[0];
+    t.test("Sample keeps name and time", first.name == "removeAll" && first.ms == ms && ms >= 0);
+    bool counted = true;
+    for (long long c : first.counts) counted = counted && (runner.countersAvailable() ? c >= -1 : c == -1);
+    t.test("Counters are counts or n/a", counted);
+    t.test("Peak RSS is read", first.peakRssKb > 0);
+    ostringstream out;
+    runner.summary(out);
+    t.test("Summary has a row per scenario",
+           out.str().find("\nremoveAll ") != string::npos && out.str().find("\nreverse ") != string::npos);
+}
+
 int main() {
     TestRunner t;
     
@@ -470,8 +1310,21 @@ int main() {
     testRemoveAllExtreme(t);
     testAverageExtreme(t);
     testMemoryStress(t);
+    testPersistent(t);
+    testRemoveAllOf(t);
+    testStorageModes(t);
+    testCompact(t);
+    testMerge(t);
+    testAnalysis(t);
+    testStaticList(t);
+    testInlineNodes(t);
+    testRunLength(t);
+    testFreeze(t);
+    testIncremental(t);
+    testIntrusiveList(t);
+    testBenchRunner(t);
     
     t.summary();
     
-    return 0;
+    return t.failures() > 0 ? 1 : 0;
 }